@@ -16,6 +16,7 @@
       'conditions': [
         ['component!="shared_library"', {
           'dependencies': [
+            '../tools/gyp/v8.gyp:aotc',
             '../tools/parser-shell.gyp:parser-shell',
           ],
         }],
@@ -1238,6 +1238,50 @@ class V8_EXPORT ScriptCompiler {
   static Local<Script> Compile(Isolate* isolate, StreamedSource* source,
                                Handle<String> full_source_string,
                                const ScriptOrigin& origin);
+
+  /**
+   * AddOptimizedCode, CollectOptimizedCode, StopCollectingOptimizedCode and
+   * ExportOptimizedCode act on a single store of optimized code for the
+   * whole process, not on an isolate: code added is loaded by every isolate,
+   * code is collected from every isolate, and an export holds the code of
+   * all of them.  Embedders that run unrelated isolates must not expect
+   * these calls to be confined to one.
+   */
+
+  /**
+   * Adds optimized code, as exported by ExportOptimizedCode or saved with
+   * --save-code, to the code that functions are optimized with.  The code is
+   * used by all isolates for the functions of scripts compiled afterwards
+   * whose source is the same as when the code was collected.  V8 keeps a
+   * copy of the data, so it can be freed once this returns.
+   *
+   * Returns false if the data was collected by a different V8 version, with
+   * different flags or for different CPU features; the functions are then
+   * optimized as usual.  Must be called after V8::Initialize.
+   */
+  static bool AddOptimizedCode(const CachedData* data);
+
+  /**
+   * Starts collecting the optimized code of all isolates for
+   * ExportOptimizedCode, as --save-code does.  Only functions optimized from
+   * now on are collected.  Must be called after V8::Initialize.
+   */
+  static void CollectOptimizedCode();
+
+  /**
+   * Stops the collection started by CollectOptimizedCode, in all isolates.
+   * The code collected so far is kept for ExportOptimizedCode.  Does nothing
+   * if code is saved because of --save-code.
+   */
+  static void StopCollectingOptimizedCode();
+
+  /**
+   * Returns the optimized code collected so far, together with the code
+   * added with AddOptimizedCode or --load-code, in the format that
+   * AddOptimizedCode takes.  Returns NULL if code is neither collected nor
+   * added.  The caller owns the returned object.
+   */
+  static CachedData* ExportOptimizedCode();
 };
 
 
@@ -0,0 +1,370 @@
+// Offline compiler for code block databases.
+//
+//   aotc [flags] manifest output
+//
+// Runs the scripts listed in the manifest, optimizes every function they
+// created, and saves the optimized code to |output| just like
+// d8 --save-code would, so that the database can be built in CI without
+// running the actual workload.  The manifest is a text file with one
+// directive per line; paths are relative to the manifest:
+//
+//   # A comment.
+//   flags --max-inlining-levels=3   V8 flags the code is generated with; these
+//                                   must match the flags it is loaded with.
+//   script app.js                   Run in order, and its functions compiled.
+//   warmup driver.js                Run after the scripts to collect type
+//                                   feedback, but not compiled itself.
+//   profile app.deopts              A --saveload-deopt-profile to read.
+//   feedback app.feedback           Inline cache states recorded with
+//                                   --saveload-record-feedback, replayed
+//                                   into the full code of the scripts.
+//   jobs 8                          The number of threads, 4 by default.
+//
+// The work is spread over the jobs' threads, each with an isolate of its
+// own; --aotc-jobs overrides the manifest.  Every thread runs all the
+// scripts and optimizes its share of the functions, sorted by script and
+// position.  Functions are only optimized then, not while the scripts run,
+// and each thread saves to a constant pool of its own, so that the output
+// only depends on the manifest and the number of jobs, not on the machine
+// or on how the threads are scheduled.  Functions that have no closure
+// once the scripts have run, e.g. inner functions that were never
+// instantiated, can't be compiled.  Without warmup scripts or recorded
+// feedback there is no type feedback, so the code takes the generic paths.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "src/v8.h"
+
+#include "include/libplatform/libplatform.h"
+#include "src/base/platform/platform.h"
+#include "src/compiler.h"
+#include "src/flags.h"
+
+using namespace v8;
+
+
+struct Manifest {
+  std::string flags;
+  std::vector<std::string> scripts;
+  std::vector<std::string> warmups;
+  std::string profile;
+  std::string feedback;
+  int jobs;
+
+  Manifest() : jobs(kDefaultJobs) {}
+
+  // Returns false and prints the reason if the manifest can't be read.
+  bool Read(const char* filename);
+
+  // Fixed rather than one per core, since the jobs decide which constant
+  // pool each block refers to.
+  static const int kDefaultJobs = 4;
+};
+
+
+static std::string ResolvePath(const std::string& directory,
+                               const std::string& path) {
+  if (path.empty() || path[0] == '/' || directory.empty()) {
+    return path;
+  }
+  return directory + "/" + path;
+}
+
+
+bool Manifest::Read(const char* filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    fprintf(stderr, "Failed to open manifest '%s'\n", filename);
+    return false;
+  }
+  std::string name(filename);
+  size_t slash = name.rfind('/');
+  std::string directory =
+      slash == std::string::npos ? std::string() : name.substr(0, slash);
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#') {
+      continue;
+    }
+    size_t end = line.find_last_not_of(" \t\r");
+    size_t space = line.find_first_of(" \t", begin);
+    std::string directive = line.substr(begin, space - begin);
+    std::string argument;
+    if (space != std::string::npos && space < end) {
+      size_t argument_begin = line.find_first_not_of(" \t", space);
+      argument = line.substr(argument_begin, end + 1 - argument_begin);
+    }
+
+    if (directive == "flags") {
+      flags += " " + argument;
+    } else if (directive == "script" && !argument.empty()) {
+      scripts.push_back(ResolvePath(directory, argument));
+    } else if (directive == "warmup" && !argument.empty()) {
+      warmups.push_back(ResolvePath(directory, argument));
+    } else if (directive == "profile" && !argument.empty()) {
+      profile = ResolvePath(directory, argument);
+    } else if (directive == "feedback" && !argument.empty()) {
+      feedback = ResolvePath(directory, argument);
+    } else if (directive == "jobs" && atoi(argument.c_str()) > 0) {
+      jobs = atoi(argument.c_str());
+    } else {
+      fprintf(stderr, "%s:%d: unknown directive '%s'\n", filename,
+              line_number, line.c_str());
+      return false;
+    }
+  }
+  if (scripts.empty()) {
+    fprintf(stderr, "%s: no scripts to compile\n", filename);
+    return false;
+  }
+  return true;
+}
+
+
+// Scripts may print their results, which is of no interest here.
+static void Print(const FunctionCallbackInfo<Value>& args) {}
+
+
+class CompilerThread : public base::Thread {
+ public:
+  CompilerThread(const Manifest* manifest, int index, int count)
+      : base::Thread(Options("aotc")),
+        manifest_(manifest),
+        index_(index),
+        count_(count),
+        succeeded_(false),
+        compiled_(0),
+        failed_(0) {}
+
+  virtual void Run() OVERRIDE;
+
+  bool succeeded() const { return succeeded_; }
+  int compiled() const { return compiled_; }
+  int failed() const { return failed_; }
+
+ private:
+  bool RunScript(Isolate* isolate, const std::string& filename);
+  bool IsScriptToCompile(i::Object* name) const;
+  void CompileFunctions(i::Isolate* isolate);
+
+  static int CompareFunctions(const i::Handle<i::JSFunction>* a,
+                              const i::Handle<i::JSFunction>* b);
+
+  const Manifest* manifest_;
+  int index_;
+  int count_;
+  bool succeeded_;
+  int compiled_;
+  int failed_;
+};
+
+
+void CompilerThread::Run() {
+  Isolate* isolate = Isolate::New();
+  {
+    Isolate::Scope isolate_scope(isolate);
+    HandleScope handle_scope(isolate);
+    Handle<ObjectTemplate> global = ObjectTemplate::New(isolate);
+    global->Set(String::NewFromUtf8(isolate, "print"),
+                FunctionTemplate::New(isolate, Print));
+    Local<Context> context = Context::New(isolate, NULL, global);
+    Context::Scope context_scope(context);
+
+    succeeded_ = true;
+    for (const std::string& script: manifest_->scripts) {
+      succeeded_ = succeeded_ && RunScript(isolate, script);
+    }
+    for (const std::string& script: manifest_->warmups) {
+      succeeded_ = succeeded_ && RunScript(isolate, script);
+    }
+    if (succeeded_) {
+      CompileFunctions(reinterpret_cast<i::Isolate*>(isolate));
+    }
+  }
+  isolate->Dispose();
+}
+
+
+bool CompilerThread::RunScript(Isolate* isolate, const std::string& filename) {
+  bool exists;
+  i::Vector<const char> chars = i::ReadFile(filename.c_str(), &exists, false);
+  if (!exists) {
+    fprintf(stderr, "Failed to read '%s'\n", filename.c_str());
+    chars.Dispose();
+    return false;
+  }
+
+  HandleScope handle_scope(isolate);
+  TryCatch try_catch;
+  Local<String> source = String::NewFromUtf8(
+      isolate, chars.start(), String::kNormalString, chars.length());
+  chars.Dispose();
+  ScriptOrigin origin(String::NewFromUtf8(isolate, filename.c_str()));
+  Local<Script> script = Script::Compile(source, &origin);
+  if (!script.IsEmpty()) {
+    script->Run();
+  }
+  if (try_catch.HasCaught()) {
+    String::Utf8Value message(try_catch.Message()->Get());
+    fprintf(stderr, "%s:%d: %s\n", filename.c_str(),
+            try_catch.Message()->GetLineNumber(), *message);
+    return false;
+  }
+  return true;
+}
+
+
+bool CompilerThread::IsScriptToCompile(i::Object* name) const {
+  if (!name->IsString()) {
+    return false;
+  }
+  i::String* string = i::String::cast(name);
+  for (const std::string& script: manifest_->scripts) {
+    if (string->IsUtf8EqualTo(i::CStrVector(script.c_str()))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+int CompilerThread::CompareFunctions(const i::Handle<i::JSFunction>* a,
+                                     const i::Handle<i::JSFunction>* b) {
+  i::SharedFunctionInfo* shared_a = (*a)->shared();
+  i::SharedFunctionInfo* shared_b = (*b)->shared();
+  int hash_a = i::Script::cast(shared_a->script())->GetSourceHash();
+  int hash_b = i::Script::cast(shared_b->script())->GetSourceHash();
+  if (hash_a != hash_b) {
+    return hash_a < hash_b ? -1 : 1;
+  }
+  int position_a = shared_a->start_position();
+  int position_b = shared_b->start_position();
+  return position_a < position_b ? -1 : (position_a > position_b ? 1 : 0);
+}
+
+
+void CompilerThread::CompileFunctions(i::Isolate* isolate) {
+  i::HandleScope scope(isolate);
+  i::List<i::Handle<i::JSFunction> > functions;
+  {
+    i::HeapIterator iterator(isolate->heap());
+    for (i::HeapObject* object = iterator.next(); object != NULL;
+         object = iterator.next()) {
+      if (!object->IsJSFunction()) {
+        continue;
+      }
+      i::JSFunction* function = i::JSFunction::cast(object);
+      i::Object* script = function->shared()->script();
+      if (script->IsScript() &&
+          i::Script::cast(script)->type()->value() ==
+              i::Script::TYPE_NORMAL &&
+          IsScriptToCompile(i::Script::cast(script)->name()) &&
+          !function->shared()->optimization_disabled()) {
+        functions.Add(i::Handle<i::JSFunction>(function));
+      }
+    }
+  }
+
+  // The same order in every thread, so that they agree on the shares.
+  functions.Sort(CompareFunctions);
+  int share = 0;
+  for (int i = 0; i < functions.length(); ++i) {
+    i::Handle<i::JSFunction> function = functions[i];
+    // Closures of the same function need to be compiled once.
+    if (i > 0 && functions[i - 1]->shared() == function->shared()) {
+      continue;
+    }
+    if (share++ % count_ != index_ || function->IsOptimized()) {
+      continue;
+    }
+
+    i::HandleScope inner_scope(isolate);
+    i::Handle<i::Code> code;
+    if (i::Compiler::GetOptimizedCode(
+            function, i::Handle<i::Code>(function->shared()->code()),
+            i::Compiler::NOT_CONCURRENT).ToHandle(&code)) {
+      compiled_++;
+    } else {
+      failed_++;
+    }
+    if (isolate->has_pending_exception()) {
+      isolate->clear_pending_exception();
+    }
+  }
+}
+
+
+int main(int argc, char** argv) {
+  int result = i::FlagList::SetFlagsFromCommandLine(&argc, argv, true);
+  if (result > 0 || argc != 3 || i::FLAG_help) {
+    ::printf("Usage: %s [flag] ... manifest output\n", argv[0]);
+    i::FlagList::PrintHelp();
+    return !i::FLAG_help;
+  }
+
+  Manifest manifest;
+  if (!manifest.Read(argv[1])) {
+    return 1;
+  }
+  if (!manifest.flags.empty()) {
+    V8::SetFlagsFromString(manifest.flags.c_str(),
+                           static_cast<int>(manifest.flags.length()));
+  }
+  // The database is set up when V8 is initialized and saved when it is
+  // disposed of.
+  i::FLAG_save_code = argv[2];
+  i::FLAG_load_code = nullptr;
+  // Which code the runtime profiler would optimize while the scripts run
+  // depends on timing, and every thread would save it.  --noopt would do,
+  // but it is part of the flag hash, so d8 would reject the database.
+  i::FLAG_aotc_runtime_profiler = false;
+  if (!manifest.profile.empty()) {
+    i::FLAG_saveload_deopt_profile = manifest.profile.c_str();
+  }
+  if (!manifest.feedback.empty()) {
+    i::FLAG_saveload_replay_feedback = manifest.feedback.c_str();
+  }
+
+  V8::InitializeICU();
+  Platform* platform = platform::CreateDefaultPlatform();
+  V8::InitializePlatform(platform);
+  V8::Initialize();
+
+  int jobs = i::FLAG_aotc_jobs > 0 ? i::FLAG_aotc_jobs : manifest.jobs;
+  std::vector<CompilerThread*> threads;
+  for (int i = 0; i < jobs; ++i) {
+    threads.push_back(new CompilerThread(&manifest, i, jobs));
+    threads.back()->Start();
+  }
+
+  bool succeeded = true;
+  int compiled = 0;
+  int failed = 0;
+  for (CompilerThread* thread: threads) {
+    thread->Join();
+    succeeded = succeeded && thread->succeeded();
+    compiled += thread->compiled();
+    failed += thread->failed();
+    delete thread;
+  }
+  ::printf("%d functions compiled, %d failed, on %d threads\n", compiled,
+           failed, jobs);
+
+  V8::Dispose();
+  V8::ShutdownPlatform();
+  delete platform;
+  if (!succeeded) {
+    // Don't leave a partial database behind for the build to pick up.
+    remove(argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -1846,6 +1846,33 @@ Local<Script> ScriptCompiler::Compile(Isolate* v8_isolate,
 }
 
 
+bool ScriptCompiler::AddOptimizedCode(const CachedData* data) {
+  return i::Compiler::AddSavedCode(i::Vector<const char>(
+      reinterpret_cast<const char*>(data->data), data->length));
+}
+
+
+void ScriptCompiler::CollectOptimizedCode() {
+  i::Compiler::CollectSavedCode();
+}
+
+
+void ScriptCompiler::StopCollectingOptimizedCode() {
+  i::Compiler::StopCollectingSavedCode();
+}
+
+
+ScriptCompiler::CachedData* ScriptCompiler::ExportOptimizedCode() {
+  i::List<char> data;
+  if (!i::Compiler::ExportSavedCode(&data)) {
+    return NULL;
+  }
+  uint8_t* buffer = i::NewArray<uint8_t>(data.length());
+  i::MemCopy(buffer, data.begin(), data.length());
+  return new CachedData(buffer, data.length(), CachedData::BufferOwned);
+}
+
+
 Local<Script> Script::Compile(v8::Handle<String> source,
                               v8::ScriptOrigin* origin) {
   i::Handle<i::String> str = Utils::OpenHandle(*source);
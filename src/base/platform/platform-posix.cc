@@ -6,6 +6,7 @@
 // own, but contains the parts which are the same across the POSIX platforms
 // Linux, MacOS, FreeBSD, OpenBSD, NetBSD and QNX.
 
+#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <pthread.h>
@@ -342,6 +343,21 @@ bool OS::Remove(const char* path) {
 }
 
 
+bool OS::ListDirectory(const char* path, std::vector<std::string>* files) {
+  DIR* dir = opendir(path);
+  if (dir == NULL) return false;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string file = std::string(path) + "/" + entry->d_name;
+    struct stat file_stat;
+    if (stat(file.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+      files->push_back(file);
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+
 FILE* OS::OpenTemporaryFile() {
   return tmpfile();
 }
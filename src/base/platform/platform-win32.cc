@@ -575,6 +575,25 @@ bool OS::Remove(const char* path) {
 }
 
 
+bool OS::ListDirectory(const char* path, std::vector<std::string>* files) {
+  WIN32_FIND_DATAA find_data;
+  std::string pattern = std::string(path) + "\\*";
+  HANDLE find = FindFirstFileA(pattern.c_str(), &find_data);
+  if (find == INVALID_HANDLE_VALUE) {
+    DWORD attributes = GetFileAttributesA(path);
+    return attributes != INVALID_FILE_ATTRIBUTES &&
+           (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+  }
+  do {
+    if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+      files->push_back(std::string(path) + "\\" + find_data.cFileName);
+    }
+  } while (FindNextFileA(find, &find_data));
+  FindClose(find);
+  return true;
+}
+
+
 FILE* OS::OpenTemporaryFile() {
   // tmpfile_s tries to use the root dir, don't use it.
   char tempPathBuffer[MAX_PATH];
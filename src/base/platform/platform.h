@@ -142,6 +142,10 @@ class OS {
   static FILE* FOpen(const char* path, const char* mode);
   static bool Remove(const char* path);
 
+  // Appends the paths of the regular files in the directory to |files|.
+  // Returns false if |path| is not a directory.
+  static bool ListDirectory(const char* path, std::vector<std::string>* files);
+
   // Opens a temporary file, the file is auto removed on close.
   static FILE* OpenTemporaryFile();
 
@@ -1,100 +1,895 @@
 #include "src/code-block-database.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/v8-platform.h"
+#include "src/assembler.h"
 #include "src/flags.h"
 #include "src/list-inl.h"
 #include "src/saveload.h"
 #include "src/utils.h"
+#include "src/v8.h"
+#include "src/version.h"
 
 namespace v8 {
 namespace internal {
 
-void CodeBlockDatabase::Read(const char* filename) {
-  // We'll leave the bright idea of loading the database from
-  // several files until the next time.
-  DCHECK(!source_);
-  source_ = filename;
+int SavedConstantPool::next_id_ = 0;
+
 
-  bool exists;
-  buffer_ = ReadFile(filename, &exists, true);
-  CHECK(exists);
-  const char* read_pointer = buffer_.start();
+SavedConstantPool::SavedConstantPool()
+    : id_(next_id_++),
+      length_(0),
+      added_(Constant::Match),
+      offsets_(nullptr),
+      start_(nullptr) {}
 
-  auto number_of_blocks = LoadPrimitive<size_t>(&read_pointer);
-  code_blocks_.Allocate(number_of_blocks);
 
-  for (size_t i = 0; i < number_of_blocks; ++i) {
-    DCHECK(read_pointer + 2 * sizeof(int) <= buffer_.end());
-    auto start_position = LoadPrimitive<int>(&read_pointer);
-    auto size = LoadPrimitive<size_t>(&read_pointer);
+SavedConstantPool::SavedConstantPool(Vector<const char> data)
+    : id_(next_id_++),
+      length_(static_cast<int>(
+          *reinterpret_cast<const uint32_t*>(data.start()))),
+      added_(Constant::Match),
+      offsets_(reinterpret_cast<const uint32_t*>(data.start()) + 1),
+      start_(data.start()) {}
 
-    DCHECK(read_pointer + size <= buffer_.end());
-    auto start = read_pointer - buffer_.start();
-    Vector<const char> code = buffer_.SubVector(start, start + size);
-    code_blocks_[i] = CodeBlock(start_position, code, false);
-    read_pointer += size;
+
+SavedConstantPool::~SavedConstantPool() {
+  for (Constant* constant: added_constants_) {
+    constant->data.Dispose();
+    delete constant;
   }
 }
 
 
-void CodeBlockDatabase::Write(const char* filename) const {
-  List<char> data;
-  SavePrimitive<size_t>(data, code_blocks_.length());
+uint32_t SavedConstantPool::Constant::Hash() const {
+  uint32_t running_hash = static_cast<uint32_t>(kind);
+  for (char c: data) {
+    running_hash = StringHasher::AddCharacterCore(running_hash,
+                                                  static_cast<uint8_t>(c));
+  }
+  return StringHasher::GetHashCore(running_hash);
+}
+
+
+bool SavedConstantPool::Constant::Match(void* key1, void* key2) {
+  Constant* constant1 = static_cast<Constant*>(key1);
+  Constant* constant2 = static_cast<Constant*>(key2);
+  return constant1->kind == constant2->kind &&
+         constant1->data.length() == constant2->data.length() &&
+         memcmp(constant1->data.start(), constant2->data.start(),
+                constant1->data.length()) == 0;
+}
+
+
+SavedConstantPool* SavedConstantPool::Read(Vector<const char> data) {
+  size_t size = static_cast<size_t>(data.length());
+  if (size < sizeof(uint32_t)) {
+    return nullptr;
+  }
+  const uint32_t* words = reinterpret_cast<const uint32_t*>(data.start());
+  uint32_t length = words[0];
+  if (length >= (size - sizeof(uint32_t)) / sizeof(uint32_t)) {
+    return nullptr;
+  }
+
+  // Every constant has a kind and lies within the pool.
+  const uint32_t* offsets = words + 1;
+  uint32_t previous = static_cast<uint32_t>((length + 2) * sizeof(uint32_t));
+  for (uint32_t i = 0; i <= length; ++i) {
+    if (offsets[i] < previous || offsets[i] > size ||
+        (i > 0 && offsets[i] == offsets[i - 1])) {
+      return nullptr;
+    }
+    previous = offsets[i];
+  }
+  return new SavedConstantPool(data);
+}
+
+
+void SavedConstantPool::Write(List<char>* data) const {
+  if (start_) {
+    // A pool read from a file is written as it was read.
+    data->AddAll(Vector<const char>(start_, offsets_[length_]));
+    return;
+  }
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  int start = data->length();
+  SavePrimitive<uint32_t>(*data, length_);
+  uint32_t offset = static_cast<uint32_t>((length_ + 2) * sizeof(uint32_t));
+  for (const Constant* constant: added_constants_) {
+    SavePrimitive<uint32_t>(*data, offset);
+    offset += 1 + constant->data.length();
+  }
+  SavePrimitive<uint32_t>(*data, offset);
+
+  for (const Constant* constant: added_constants_) {
+    data->Add(static_cast<char>(constant->kind));
+    data->AddAll(constant->data);
+  }
+  DCHECK(static_cast<uint32_t>(data->length() - start) == offset);
+  USE(start);
+}
+
+
+Vector<const char> SavedConstantPool::GetEntry(int index) const {
+  DCHECK(start_ && index >= 0 && index < length_);
+  return Vector<const char>(start_ + offsets_[index],
+                            offsets_[index + 1] - offsets_[index]);
+}
+
+
+int SavedConstantPool::length() const {
+  if (!start_) {
+    base::LockGuard<base::Mutex> lock_guard(&mutex_);
+    return length_;
+  }
+  return length_;
+}
+
+
+SavedConstantPool::Kind SavedConstantPool::GetKind(int index) const {
+  if (!start_) {
+    base::LockGuard<base::Mutex> lock_guard(&mutex_);
+    return added_constants_[index]->kind;
+  }
+  return static_cast<Kind>(GetEntry(index)[0]);
+}
+
+
+Vector<const char> SavedConstantPool::GetData(int index) const {
+  if (!start_) {
+    // The data itself is not moved by later additions.
+    base::LockGuard<base::Mutex> lock_guard(&mutex_);
+    return added_constants_[index]->data;
+  }
+  Vector<const char> entry = GetEntry(index);
+  return entry.SubVector(1, entry.length());
+}
+
+
+int SavedConstantPool::Add(Kind kind, Vector<const char> data) {
+  DCHECK(!start_);
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  Constant key = { kind, data, -1 };
+  HashMap::Entry* entry = added_.Lookup(&key, key.Hash(), true);
+  if (!entry->value) {
+    Vector<char> copy = Vector<char>::New(data.length());
+    CopyChars(copy.start(), data.start(), data.length());
+    Constant* constant =
+        new Constant{ kind, Vector<const char>(copy.start(), copy.length()),
+                      length_++ };
+    // The key must outlive the lookup.
+    entry->key = constant;
+    entry->value = constant;
+    added_constants_.Add(constant);
+  }
+  return static_cast<Constant*>(entry->value)->index;
+}
+
+
+CodeBlockDatabase::Header CodeBlockDatabase::Header::Current() {
+  Header header = { kMagicNumber,
+                    kFormatVersion,
+                    static_cast<uint32_t>(Version::Hash()),
+                    FlagList::Hash(),
+                    CpuFeatures::SupportedFeatures(),
+                    0,
+                    0,
+                    0 };
+  return header;
+}
+
+
+const char* CodeBlockDatabase::Header::Mismatch() const {
+  Header current = Current();
+  if (magic_number != current.magic_number) {
+    return "not a code block database";
+  }
+  if (format_version != current.format_version) {
+    return "format version mismatch";
+  }
+  if (version_hash != current.version_hash) {
+    return "V8 version mismatch";
+  }
+  if (flag_hash != current.flag_hash) {
+    return "flag mismatch";
+  }
+  // Code that doesn't use some of the features we have is fine, code that
+  // uses features we don't have is not.
+  if ((cpu_features & ~current.cpu_features) != 0) {
+    return "CPU feature mismatch";
+  }
+  return nullptr;
+}
+
 
-  for (int i = 0; i < code_blocks_.length(); ++i) {
-    SavePrimitive<int>(data, code_blocks_[i].StartPosition());
-    SavePrimitive<size_t>(data, code_blocks_[i].Code().length());
-    data.AddAll(code_blocks_[i].Code());
+bool CodeBlockDatabase::IndexEntry::Replaces(const IndexEntry& other,
+                                             MergePolicy policy) const {
+  switch (policy) {
+    case kFewestDeopts:
+      if (deopt_count != other.deopt_count) {
+        return deopt_count < other.deopt_count;
+      }
+      break;
+    case kMostInlining:
+      if (inlined_functions != other.inlined_functions) {
+        return inlined_functions > other.inlined_functions;
+      }
+      break;
+    case kNewest:
+      break;
   }
+  // Ties go to the newer block, then to the one found first.
+  return generation > other.generation;
+}
+
+
+// static
+bool CodeBlockDatabase::ParseMergePolicy(const char* name,
+                                         MergePolicy* policy) {
+  if (strcmp(name, "newest") == 0) {
+    *policy = kNewest;
+  } else if (strcmp(name, "fewest-deopts") == 0) {
+    *policy = kFewestDeopts;
+  } else if (strcmp(name, "most-inlining") == 0) {
+    *policy = kMostInlining;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+
+// Adler-32.
+uint32_t CodeBlockDatabase::Checksum(Vector<const char> code) {
+  static const uint32_t kModulus = 65521;
+  // The largest number of bytes that can be summed up without overflow.
+  static const int kBlockSize = 5552;
+  uint32_t a = 1;
+  uint32_t b = 0;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(code.start());
+  int remaining = code.length();
+  while (remaining > 0) {
+    int block_size = Min(remaining, kBlockSize);
+    remaining -= block_size;
+    while (block_size-- > 0) {
+      a += *bytes++;
+      b += a;
+    }
+    a %= kModulus;
+    b %= kModulus;
+  }
+  return (b << 16) | a;
+}
+
+
+void CodeBlockDatabase::Open(const char* source) {
+  std::string paths(source);
+  size_t begin = 0;
+  while (begin <= paths.length()) {
+    size_t end = paths.find(',', begin);
+    if (end == std::string::npos) {
+      end = paths.length();
+    }
+    std::string path = paths.substr(begin, end - begin);
+    begin = end + 1;
+    if (path.empty()) {
+      continue;
+    }
 
+    std::vector<std::string> entries;
+    if (base::OS::ListDirectory(path.c_str(), &entries)) {
+      // Sort, so that the lookup order does not depend on the file system.
+      std::sort(entries.begin(), entries.end());
+      for (const std::string& entry: entries) {
+        Read(entry.c_str());
+      }
+    } else {
+      Read(path.c_str());
+    }
+  }
+}
+
+
+bool CodeBlockDatabase::Read(const char* filename) {
+  File file;
+  file.owns_buffer = true;
+  // Map the file, so that code blocks are only paged in when they are
+  // actually loaded.  Fall back to reading the whole file otherwise.
+  file.mapping = base::OS::MemoryMappedFile::open(filename);
+  if (file.mapping) {
+    file.buffer =
+        Vector<const char>(static_cast<const char*>(file.mapping->memory()),
+                           file.mapping->size());
+  } else {
+    bool exists;
+    file.buffer = ReadFile(filename, &exists, false);
+    if (!exists) {
+      file.buffer.Dispose();
+      return false;
+    }
+  }
+  return Add(file, filename);
+}
+
+
+bool CodeBlockDatabase::Read(Vector<const char> data) {
+  File file;
+  file.mapping = nullptr;
+  file.owns_buffer = true;
+  Vector<char> buffer = Vector<char>::New(data.length());
+  MemCopy(buffer.start(), data.start(), data.length());
+  file.buffer = Vector<const char>(buffer.start(), buffer.length());
+  return Add(file, "<memory>");
+}
+
+
+bool CodeBlockDatabase::ReadEmbedded(Vector<const char> data) {
+  if (reinterpret_cast<uintptr_t>(data.start()) % sizeof(uint32_t) != 0) {
+    return Read(data);
+  }
+  File file;
+  file.mapping = nullptr;
+  file.owns_buffer = false;
+  file.buffer = data;
+  return Add(file, "<snapshot>");
+}
+
+
+bool CodeBlockDatabase::Add(File file, const char* name) {
+  file.states = nullptr;
+  file.pools = nullptr;
+  file.number_of_pools = 0;
+
+  const Header* header = reinterpret_cast<const Header*>(file.buffer.start());
+  const char* mismatch = nullptr;
+  size_t file_size = static_cast<size_t>(file.buffer.length());
+  if (file_size < sizeof(Header)) {
+    mismatch = "not a code block database";
+  } else {
+    mismatch = header->Mismatch();
+    size_t tables_size = file_size - sizeof(Header);
+    if (!mismatch &&
+        header->number_of_pools > tables_size / sizeof(PoolEntry)) {
+      mismatch = "pool table is truncated";
+    }
+    if (!mismatch &&
+        header->number_of_blocks >
+            (tables_size - header->number_of_pools * sizeof(PoolEntry)) /
+                sizeof(IndexEntry)) {
+      mismatch = "index is truncated";
+    }
+  }
+
+  // The constant pools are small and needed by every block, so they are
+  // checked right away.
+  if (!mismatch) {
+    const PoolEntry* pool_entries =
+        reinterpret_cast<const PoolEntry*>(header + 1);
+    file.pools = new SavedConstantPool*[header->number_of_pools];
+    for (uint32_t i = 0; i < header->number_of_pools; ++i) {
+      const PoolEntry& entry = pool_entries[i];
+      SavedConstantPool* pool = nullptr;
+      if (entry.offset <= file_size && entry.size <= file_size - entry.offset &&
+          entry.offset % sizeof(uint32_t) == 0) {
+        Vector<const char> constants(file.buffer.start() + entry.offset,
+                                     entry.size);
+        if (Checksum(constants) == entry.checksum) {
+          pool = SavedConstantPool::Read(constants);
+        }
+      }
+      if (!pool) {
+        mismatch = "constant pool is damaged";
+        break;
+      }
+      file.pools[file.number_of_pools++] = pool;
+    }
+  }
+
+  if (mismatch) {
+    if (FLAG_trace_saveload) {
+      PrintF("[code block database \"%s\" rejected: %s]\n", name, mismatch);
+    }
+    file.Dispose();
+    return false;
+  }
+
+  file.number_of_blocks = static_cast<int>(header->number_of_blocks);
+  file.index = reinterpret_cast<const IndexEntry*>(
+      reinterpret_cast<const PoolEntry*>(header + 1) + file.number_of_pools);
+  file.generation = header->generation;
+  file.states = new base::Atomic32[file.number_of_blocks];
+  for (int i = 0; i < file.number_of_blocks; ++i) {
+    base::NoBarrier_Store(&file.states[i], kUnverified);
+  }
+  file.next = 0;
+
+  // Lookups on other threads may be walking the files, so the file is only
+  // linked in once it is complete.
+  File* added = new File(file);
+  base::AtomicWord address = reinterpret_cast<base::AtomicWord>(added);
+  if (last_file_) {
+    base::Release_Store(&last_file_->next, address);
+  } else {
+    base::Release_Store(&first_file_, address);
+  }
+  last_file_ = added;
+
+  if (FLAG_trace_saveload) {
+    PrintF("[code block database \"%s\" %s, %d blocks]\n", name,
+           file.mapping ? "mapped" : "read", file.number_of_blocks);
+  }
+  return true;
+}
+
+
+void CodeBlockDatabase::Write(const char* filename,
+                              MergePolicy policy) const {
+  List<char> data;
+  int number_of_blocks = Write(&data, policy);
+
+  // The file being replaced may be one of the files mapped, and a run
+  // that fails halfway should not lose what earlier runs saved.
+  std::string temporary_filename = std::string(filename) + ".tmp";
   Vector<const char> buffer = data.ToConstVector();
-  WriteChars(filename, buffer.start(), buffer.length(), true);
+  if (WriteChars(temporary_filename.c_str(), buffer.start(), buffer.length(),
+                 true) != buffer.length() ||
+      std::rename(temporary_filename.c_str(), filename) != 0) {
+    PrintF("[code block database could not be saved to \"%s\"]\n", filename);
+    std::remove(temporary_filename.c_str());
+    return;
+  }
 
   if (FLAG_trace_saveload) {
-    PrintF("[code block database saved to \"%s\"]\n", filename);
+    PrintF("[code block database saved to \"%s\", %d blocks]\n", filename,
+           number_of_blocks);
   }
 }
 
 
-void CodeBlockDatabase::SetCode(int start_position, Vector<const char> code) {
-  for (CodeBlock& code_block: code_blocks_) {
-    if (code_block.StartPosition() == start_position) {
-      code_block.SetCode(code, true);
-      return;
+int CodeBlockDatabase::Write(List<char>* data, MergePolicy policy) const {
+  // A block to write, either added during this run or read from a file.
+  struct MergedBlock {
+    IndexEntry entry;
+    Vector<const char> code;
+    const SavedConstantPool* constants;
+  };
+
+  // The blocks added during this run are newer than any block read.
+  uint32_t generation = 0;
+  for (const File* file = first_file(); file; file = file->next_file()) {
+    generation = Max(generation, file->generation);
+  }
+  generation++;
+
+  // Sorted by key, as the index must be.
+  std::map<Key, MergedBlock> blocks;
+  for (HashMap::Entry* entry = code_blocks_.Start(); entry;
+       entry = code_blocks_.Next(entry)) {
+    const CodeBlock* code_block = static_cast<CodeBlock*>(entry->value);
+    const Key* key = code_block->GetKey();
+    Profile profile = code_block->GetProfile();
+    MergedBlock block = {
+        { key->source_hash,
+          key->start_position,
+          key->osr_ast_id,
+          0,
+          static_cast<uint32_t>(code_block->Code().length()),
+          Checksum(code_block->Code()),
+          0,
+          generation,
+          profile.deopt_count,
+          profile.inlined_functions },
+        code_block->Code(),
+        code_block->Constants() };
+    blocks.insert(std::make_pair(*key, block));
+  }
+
+  for (const File* file = first_file(); file; file = file->next_file()) {
+    for (int i = 0; i < file->number_of_blocks; ++i) {
+      const IndexEntry* entry = &file->index[i];
+      Key key = entry->GetKey();
+      if (removed_keys_.count(key)) {
+        continue;
+      }
+      // Damaged blocks are dropped.
+      Vector<const char> code = file->GetCode(entry);
+      if (code.is_empty()) {
+        continue;
+      }
+      MergedBlock block = { *entry, code, file->pools[entry->pool] };
+      auto result = blocks.insert(std::make_pair(key, block));
+      if (!result.second &&
+          block.entry.Replaces(result.first->second.entry, policy)) {
+        result.first->second = block;
+      }
+    }
+  }
+
+  // Only the pools that some block refers to are written.
+  std::vector<const SavedConstantPool*> pools;
+  std::map<const SavedConstantPool*, uint32_t> pool_indices;
+  for (auto& key_and_block: blocks) {
+    MergedBlock& block = key_and_block.second;
+    auto result = pool_indices.insert(
+        std::make_pair(block.constants, static_cast<uint32_t>(pools.size())));
+    if (result.second) {
+      pools.push_back(block.constants);
     }
+    block.entry.pool = result.first->second;
+  }
+
+  List<char> constants;
+  List<PoolEntry> pool_entries;
+  for (const SavedConstantPool* pool: pools) {
+    int start = constants.length();
+    pool->Write(&constants);
+    Vector<const char> data =
+        constants.ToConstVector().SubVector(start, constants.length());
+    PoolEntry entry = { static_cast<uint32_t>(start),
+                        static_cast<uint32_t>(data.length()),
+                        Checksum(data) };
+    pool_entries.Add(entry);
+    // Keep the next pool's offsets aligned.
+    while (constants.length() % sizeof(uint32_t) != 0) {
+      constants.Add(0);
+    }
+  }
+
+  Header header = Header::Current();
+  header.number_of_blocks = static_cast<uint32_t>(blocks.size());
+  header.number_of_pools = static_cast<uint32_t>(pools.size());
+  header.generation = generation;
+
+  int start = data->length();
+  SavePrimitive<Header>(*data, header);
+
+  size_t offset = sizeof(Header) + pools.size() * sizeof(PoolEntry) +
+                  blocks.size() * sizeof(IndexEntry);
+  for (PoolEntry entry: pool_entries) {
+    entry.offset += static_cast<uint32_t>(offset);
+    SavePrimitive<PoolEntry>(*data, entry);
+  }
+  offset += constants.length();
+
+  for (auto& key_and_block: blocks) {
+    MergedBlock& block = key_and_block.second;
+    CHECK(offset + block.code.length() <= kMaxUInt32);
+    block.entry.offset = static_cast<uint32_t>(offset);
+    SavePrimitive<IndexEntry>(*data, block.entry);
+    offset += block.code.length();
+  }
+
+  data->AddAll(constants.ToConstVector());
+  for (const auto& key_and_block: blocks) {
+    data->AddAll(key_and_block.second.code);
+  }
+  DCHECK(static_cast<size_t>(data->length() - start) == offset);
+  return static_cast<int>(header.number_of_blocks);
+}
+
+
+void CodeBlockDatabase::File::Dispose() {
+  for (int i = 0; i < number_of_pools; ++i) {
+    delete pools[i];
+  }
+  delete[] pools;
+  delete[] states;
+  if (mapping) {
+    delete mapping;
+  } else if (owns_buffer) {
+    buffer.Dispose();
   }
-  code_blocks_.Add({ start_position, code, true });
 }
 
 
-bool CodeBlockDatabase::HasCode(int start_position) const {
-  for (CodeBlock& code_block: code_blocks_) {
-    if (code_block.StartPosition() == start_position) {
-      return true;
+const CodeBlockDatabase::IndexEntry* CodeBlockDatabase::File::FindIndexEntry(
+    const Key& key) const {
+  int low = 0;
+  int high = number_of_blocks - 1;
+  while (low <= high) {
+    int middle = low + (high - low) / 2;
+    const IndexEntry* entry = &index[middle];
+    Key middle_key = entry->GetKey();
+    if (middle_key < key) {
+      low = middle + 1;
+    } else if (key < middle_key) {
+      high = middle - 1;
+    } else {
+      return entry;
     }
   }
-  return false;
+  return nullptr;
 }
 
 
-Vector<const char> CodeBlockDatabase::GetCode(int start_position) const {
-  for (CodeBlock& code_block: code_blocks_) {
-    if (code_block.StartPosition() == start_position) {
-      return code_block.Code();
+const CodeBlockDatabase::IndexEntry* CodeBlockDatabase::File::LowerBound(
+    const Key& key) const {
+  int low = 0;
+  int high = number_of_blocks;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    if (index[middle].GetKey() < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
     }
   }
-  UNREACHABLE();
-  return Vector<const char>();
+  return &index[low];
 }
 
 
-bool CodeBlockDatabase::RemoveCode(int start_position) {
-  for (int index = 0; index < code_blocks_.length(); ++index) {
-    if (code_blocks_[index].StartPosition() == start_position) {
-      code_blocks_.Remove(index);
-      return true;
+CodeBlockDatabase::BlockState CodeBlockDatabase::File::Verify(
+    const IndexEntry* entry) const {
+  base::Atomic32* state = &states[entry - index];
+  BlockState result = static_cast<BlockState>(base::Acquire_Load(state));
+  if (result != kUnverified) {
+    return result;
+  }
+
+  size_t file_size = static_cast<size_t>(buffer.length());
+  if (entry->offset > file_size || entry->size > file_size - entry->offset ||
+      entry->pool >= static_cast<uint32_t>(number_of_pools)) {
+    result = kDamaged;
+  } else {
+    Vector<const char> code(buffer.start() + entry->offset, entry->size);
+    result = Checksum(code) == entry->checksum ? kValid : kDamaged;
+  }
+  // Both threads may get here for the same block, but they will come to
+  // the same conclusion.
+  base::Release_Store(state, result);
+  return result;
+}
+
+
+Vector<const char> CodeBlockDatabase::File::GetCode(
+    const IndexEntry* entry) const {
+  if (Verify(entry) != kValid) {
+    if (FLAG_trace_saveload) {
+      PrintF("[saved code for %d is damaged]\n", entry->start_position);
+    }
+    return Vector<const char>();
+  }
+  // No copying: the returned vector points into the mapped file.
+  return Vector<const char>(buffer.start() + entry->offset, entry->size);
+}
+
+
+class CodeBlockDatabase::VerificationTask : public v8::Task {
+ public:
+  VerificationTask(CodeBlockDatabase* database, const File* file)
+      : database_(database), file_(file) {}
+
+  virtual ~VerificationTask() {}
+
+ private:
+  // v8::Task overrides.
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < file_->number_of_blocks; ++i) {
+      if (base::Acquire_Load(&database_->verification_aborted_)) {
+        break;
+      }
+      file_->Verify(&file_->index[i]);
     }
+    database_->verification_tasks_semaphore_.Signal();
+  }
+
+  CodeBlockDatabase* database_;
+  const File* file_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerificationTask);
+};
+
+
+void CodeBlockDatabase::VerifyInBackground() {
+  for (const File* file = first_file(); file; file = file->next_file()) {
+    pending_verification_tasks_++;
+    V8::GetCurrentPlatform()->CallOnBackgroundThread(
+        new VerificationTask(this, file), v8::Platform::kShortRunningTask);
+  }
+}
+
+
+class CodeBlockDatabase::KeysVerificationTask : public v8::Task {
+ public:
+  explicit KeysVerificationTask(CodeBlockDatabase* database)
+      : database_(database) {}
+
+  virtual ~KeysVerificationTask() {}
+
+  void Add(const File* file, const IndexEntry* entry) {
+    files_.Add(file);
+    entries_.Add(entry);
+  }
+
+  bool is_empty() const { return entries_.is_empty(); }
+
+ private:
+  // v8::Task overrides.
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < entries_.length(); ++i) {
+      if (base::Acquire_Load(&database_->verification_aborted_)) {
+        break;
+      }
+      files_[i]->Verify(entries_[i]);
+    }
+    database_->verification_tasks_semaphore_.Signal();
+  }
+
+  CodeBlockDatabase* database_;
+  List<const File*> files_;
+  List<const IndexEntry*> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(KeysVerificationTask);
+};
+
+
+void CodeBlockDatabase::VerifyInBackground(const List<Key>& keys) {
+  KeysVerificationTask* task = new KeysVerificationTask(this);
+  for (const Key& key: keys) {
+    const File* file;
+    const IndexEntry* entry = FindIndexEntry(key, &file);
+    if (entry) {
+      task->Add(file, entry);
+    }
+  }
+  if (task->is_empty()) {
+    delete task;
+    return;
+  }
+  pending_verification_tasks_++;
+  V8::GetCurrentPlatform()->CallOnBackgroundThread(
+      task, v8::Platform::kShortRunningTask);
+}
+
+
+void CodeBlockDatabase::AbortVerification() {
+  base::Release_Store(&verification_aborted_, 1);
+  while (pending_verification_tasks_ > 0) {
+    verification_tasks_semaphore_.Wait();
+    pending_verification_tasks_--;
+  }
+}
+
+
+const CodeBlockDatabase::IndexEntry* CodeBlockDatabase::FindIndexEntry(
+    const Key& key, const File** file) const {
+  // Files are searched in the order they were read.
+  for (const File* candidate = first_file(); candidate;
+       candidate = candidate->next_file()) {
+    const IndexEntry* entry = candidate->FindIndexEntry(key);
+    if (entry) {
+      *file = candidate;
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+
+CodeBlockDatabase::CodeBlock* CodeBlockDatabase::FindCodeBlock(
+    const Key& key) const {
+  HashMap::Entry* entry =
+      code_blocks_.Lookup(const_cast<Key*>(&key), key.Hash(), false);
+  return entry ? static_cast<CodeBlock*>(entry->value) : nullptr;
+}
+
+
+void CodeBlockDatabase::GetStartPositions(int source_hash,
+                                          List<int>* start_positions) const {
+  int first = start_positions->length();
+  Key first_key(source_hash, kMinInt, kMinInt);
+  for (const File* file = first_file(); file; file = file->next_file()) {
+    const IndexEntry* end = file->index + file->number_of_blocks;
+    for (const IndexEntry* entry = file->LowerBound(first_key);
+         entry < end && entry->source_hash == source_hash; ++entry) {
+      if (entry->osr_ast_id == Key::kNoOsrAstId &&
+          !removed_keys_.count(entry->GetKey())) {
+        start_positions->Add(entry->start_position);
+      }
+    }
+  }
+  for (HashMap::Entry* entry = code_blocks_.Start(); entry;
+       entry = code_blocks_.Next(entry)) {
+    const Key* key = static_cast<CodeBlock*>(entry->value)->GetKey();
+    if (key->source_hash == source_hash &&
+        key->osr_ast_id == Key::kNoOsrAstId) {
+      start_positions->Add(key->start_position);
+    }
+  }
+
+  // A function may have blocks in several files and in this run.
+  int* begin = start_positions->begin() + first;
+  std::sort(begin, start_positions->end());
+  int* end = std::unique(begin, start_positions->end());
+  start_positions->Rewind(static_cast<int>(end - start_positions->begin()));
+}
+
+
+SavedConstantPool* CodeBlockDatabase::NewConstants(int owner) {
+  SavedConstantPool*& constants = new_constants_[owner];
+  if (!constants) {
+    constants = new SavedConstantPool;
+  }
+  return constants;
+}
+
+
+void CodeBlockDatabase::SetCode(const Key& key, Vector<const char> code,
+                                Profile profile, int owner) {
+  CodeBlock* code_block =
+      new CodeBlock(key, code, profile, NewConstants(owner), true);
+  const Key* block_key = code_block->GetKey();
+  HashMap::Entry* entry = code_blocks_.Lookup(const_cast<Key*>(block_key),
+                                              block_key->Hash(), true);
+  if (entry->value) {
+    retired_code_blocks_.Add(static_cast<CodeBlock*>(entry->value));
+  }
+  // The key must outlive the lookup.
+  entry->key = const_cast<Key*>(block_key);
+  entry->value = code_block;
+}
+
+
+bool CodeBlockDatabase::HasCode(const Key& key) const {
+  return FindCodeBlock(key) || HasCodeInFiles(key);
+}
+
+
+Vector<const char> CodeBlockDatabase::GetCode(
+    const Key& key, const SavedConstantPool** constants) const {
+  CodeBlock* code_block = FindCodeBlock(key);
+  if (code_block) {
+    if (constants) {
+      *constants = code_block->Constants();
+    }
+    return code_block->Code();
+  }
+  return GetCodeFromFiles(key, constants);
+}
+
+
+bool CodeBlockDatabase::HasCodeInFiles(const Key& key) const {
+  const File* file;
+  return FindIndexEntry(key, &file) != nullptr;
+}
+
+
+Vector<const char> CodeBlockDatabase::GetCodeFromFiles(
+    const Key& key, const SavedConstantPool** constants) const {
+  const File* file;
+  const IndexEntry* entry = FindIndexEntry(key, &file);
+  if (entry) {
+    // Verifies the pool index too.
+    Vector<const char> code = file->GetCode(entry);
+    if (constants && !code.is_empty()) {
+      *constants = file->pools[entry->pool];
+    }
+    return code;
+  }
+  // The block may have been removed since HasCode found it, e.g. when the
+  // same script is compiled again and its code deoptimized in between.
+  return Vector<const char>();
+}
+
+
+bool CodeBlockDatabase::RemoveCode(const Key& key) {
+  bool removed = false;
+  void* code_block = code_blocks_.Remove(const_cast<Key*>(&key), key.Hash());
+  if (code_block) {
+    retired_code_blocks_.Add(static_cast<CodeBlock*>(code_block));
+    removed = true;
+  }
+  const File* file;
+  if (FindIndexEntry(key, &file) && removed_keys_.insert(key).second) {
+    removed = true;
   }
-  return false;
+  return removed;
 }
 
 } }  // namespace v8::internal
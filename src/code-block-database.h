@@ -1,56 +1,396 @@
 #ifndef V8_CODE_BLOCK_DATABASE_H_
 #define V8_CODE_BLOCK_DATABASE_H_
 
+#include <map>
+#include <set>
+
+#include "src/base/atomicops.h"
+#include "src/base/platform/platform.h"
+#include "src/hashmap.h"
 #include "src/list.h"
 #include "src/vector.h"
 
 namespace v8 {
 namespace internal {
 
+// Constants shared by the code blocks of a database, so that each of them
+// is saved once per file rather than once per block, and materialized at
+// most once per isolate (see Isolate::GetSavedConstants).  Code blocks refer
+// to them by index.
+//
+// A pool read from a file never changes.  A pool that constants are added
+// to may be read by isolates loading the blocks saved during this run while
+// others save more, so its constants are accessed under a lock of its own;
+// once added, a constant stays where it is until the pool is destroyed.
+//
+// On-disk layout:
+//
+//   uint32_t number_of_constants
+//   uint32_t offsets[number_of_constants + 1], from the start of the pool
+//   constants: a Kind byte followed by the data
+class SavedConstantPool {
+ public:
+  enum Kind {
+    kInternalizedString,  // UTF-8.
+    kHeapNumber  // A double.
+  };
+
+  // An empty pool to add constants to.
+  SavedConstantPool();
+
+  ~SavedConstantPool();
+
+  // Returns nullptr if |data| is not a valid pool.  The data is not copied,
+  // so it must outlive the pool.
+  static SavedConstantPool* Read(Vector<const char> data);
+  void Write(List<char>* data) const;
+
+  // Identifies the pool among all pools of the process.
+  int id() const { return id_; }
+
+  int length() const;
+  Kind GetKind(int index) const;
+  Vector<const char> GetData(int index) const;
+
+  // Returns the index of the constant, adding it if there is none equal.
+  int Add(Kind kind, Vector<const char> data);
+
+ private:
+  struct Constant {
+    Kind kind;
+    Vector<const char> data;
+    int index;
+
+    uint32_t Hash() const;
+
+    static bool Match(void* key1, void* key2);
+  };
+
+  explicit SavedConstantPool(Vector<const char> data);
+
+  Vector<const char> GetEntry(int index) const;
+
+  int id_;
+  int length_;
+
+  // Constants added during this run.
+  mutable base::Mutex mutex_;
+  HashMap added_;
+  List<Constant*> added_constants_;
+
+  // Constants read from a file.
+  const uint32_t* offsets_;
+  const char* start_;
+
+  static int next_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(SavedConstantPool);
+};
+
+
+// On-disk layout of a code block database:
+//
+//   Header
+//   PoolEntry[number_of_pools]
+//   IndexEntry[number_of_blocks], sorted by key
+//   SavedConstantPools, each padded to a multiple of 4 bytes
+//   code blocks, referenced from the index by offset and size
+//
+// The files are memory-mapped on load, so that only the code blocks that are
+// actually requested are paged in.  Several files, e.g. saved by different
+// applications, can be loaded at once.
+//
+// Writing a database that has files loaded merges them: the blocks read from
+// the files are written along with the blocks added during this run, and
+// where several have the same key, a MergePolicy picks the one to keep.
+// Blocks keep referring to the pool they were saved with, so a merged file
+// has a pool per training run that contributed to it.
+//
+// Saved code is only valid for the V8 version, flags and CPU features it was
+// generated with, so these are recorded in the header.  A file that doesn't
+// match is not loaded, and a block whose checksum doesn't match is not used;
+// the functions are then compiled as usual.  Checksums can be verified on
+// background threads ahead of time, which also pages the code in, so that
+// the main thread doesn't have to wait for either when loading.
+//
+// One database serves all isolates of the process.  The files read never
+// change once they are added, so the isolates look up their blocks without
+// locking (see HasCodeInFiles and GetCodeFromFiles) and share one mapping
+// of each file.  Everything else, i.e. reading files and the blocks saved
+// during this run, must be serialized by the caller.  What an isolate made
+// of the loaded code, such as the constants it materialized or the
+// functions whose saved code it discarded, is kept by the isolate.
 class CodeBlockDatabase {
  public:
-  CodeBlockDatabase(const char* filename = nullptr)
-      : source_(nullptr) {
-    if (filename) {
-      Read(filename);
+  // Code blocks are identified by the script they come from, by the
+  // position of the function within that script and by the loop the code
+  // is entered at on stack replacement.
+  struct Key {
+    static const int kNoOsrAstId = -1;  // BailoutId::None()
+
+    int source_hash;  // Script::GetSourceHash
+    int start_position;
+    int osr_ast_id;  // kNoOsrAstId for code entered by calls.
+
+    Key(int source_hash, int start_position, int osr_ast_id = kNoOsrAstId)
+        : source_hash(source_hash),
+          start_position(start_position),
+          osr_ast_id(osr_ast_id) {}
+
+    uint32_t Hash() const {
+      return ComputeIntegerHash(
+          static_cast<uint32_t>(source_hash) ^
+              static_cast<uint32_t>(start_position) ^
+              (static_cast<uint32_t>(osr_ast_id) << 16), 0);
+    }
+
+    bool operator==(const Key& other) const {
+      return source_hash == other.source_hash &&
+             start_position == other.start_position &&
+             osr_ast_id == other.osr_ast_id;
+    }
+
+    bool operator<(const Key& other) const {
+      if (source_hash != other.source_hash) {
+        return source_hash < other.source_hash;
+      }
+      if (start_position != other.start_position) {
+        return start_position < other.start_position;
+      }
+      return osr_ast_id < other.osr_ast_id;
+    }
+  };
+
+  // How well the code of a block did in the run that saved it, which is
+  // what the merge policies compare.
+  struct Profile {
+    uint32_t deopt_count;  // SharedFunctionInfo::deopt_count when saved.
+    uint32_t inlined_functions;
+  };
+
+  enum MergePolicy {
+    kNewest,  // The block saved by the latest run.
+    kFewestDeopts,
+    kMostInlining
+  };
+
+  // Parses "newest", "fewest-deopts" or "most-inlining".
+  static bool ParseMergePolicy(const char* name, MergePolicy* policy);
+
+  // |source| is a comma-separated list of files and directories to load.
+  // Every file in a directory that looks like a code block database is
+  // loaded.
+  CodeBlockDatabase(const char* source = nullptr)
+      : source_(source),
+        code_blocks_(CodeBlock::Match),
+        first_file_(0),
+        last_file_(nullptr),
+        verification_aborted_(0),
+        pending_verification_tasks_(0),
+        verification_tasks_semaphore_(0) {
+    if (source) {
+      Open(source);
     }
   }
 
   ~CodeBlockDatabase() {
-    for (CodeBlock& code_block: code_blocks_) {
-      code_block.DisposeIfNeeded();
+    AbortVerification();
+    for (HashMap::Entry* entry = code_blocks_.Start(); entry;
+         entry = code_blocks_.Next(entry)) {
+      delete static_cast<CodeBlock*>(entry->value);
+    }
+    for (CodeBlock* code_block: retired_code_blocks_) {
+      delete code_block;
+    }
+    for (auto& owner_and_constants: new_constants_) {
+      delete owner_and_constants.second;
+    }
+    const File* next;
+    for (const File* file = first_file(); file; file = next) {
+      next = file->next_file();
+      const_cast<File*>(file)->Dispose();
+      delete file;
     }
-    buffer_.Dispose();
   }
 
   const char* Source() const { return source_; }
 
-  void Read(const char* filename);
-  void Write(const char* filename) const;
+  // Returns false if |filename| does not exist, is not a code block database
+  // or was saved by an incompatible configuration.
+  bool Read(const char* filename);
+  // Reads a database that is already in memory, e.g. one an embedder
+  // supplied.  The data is copied.  Blocks that haven't been verified in the
+  // background yet are verified when they are looked up.
+  bool Read(Vector<const char> data);
+  // Reads a database that stays in memory as long as the process, i.e. the
+  // one embedded in the snapshot, without copying it.  Falls back to Read if
+  // |data| is not aligned for the tables to be read in place.
+  bool ReadEmbedded(Vector<const char> data);
+  // Also writes the blocks read from files, see MergePolicy.  The file is
+  // replaced only once it has been written completely, so it may be one of
+  // the files read.
+  void Write(const char* filename, MergePolicy policy = kNewest) const;
+  // Appends what Write would write to |data|.  Returns the number of blocks.
+  int Write(List<char>* data, MergePolicy policy = kNewest) const;
 
-  void SetCode(int start_position, Vector<const char> code);
-  bool HasCode(int start_position) const;
-  Vector<const char> GetCode(int start_position) const;
-  bool RemoveCode(int start_position);
+  // Blocks added with SetCode refer to the constants in NewConstants of the
+  // same |owner|, e.g. the isolate that saved them.  With a pool per owner,
+  // the constants of a pool and the order they are added in don't depend on
+  // how the owners interleave, so the file written doesn't either.
+  void SetCode(const Key& key, Vector<const char> code,
+               Profile profile = Profile(), int owner = 0);
+  bool HasCode(const Key& key) const;
+  // Returns an empty vector if there is no block for |key| or it is
+  // damaged.  Otherwise |constants|, if given, is set to the pool the block
+  // refers to.
+  Vector<const char> GetCode(const Key& key,
+                             const SavedConstantPool** constants = nullptr)
+      const;
+  // Blocks read from files can still be looked up after they are removed,
+  // but they are no longer written.  The code of blocks added with SetCode
+  // that are removed or replaced is kept until the database is destroyed,
+  // since other isolates may still be loading it.
+  bool RemoveCode(const Key& key);
+
+  // Like HasCode and GetCode, but only look at the blocks read from files.
+  // These may be called from any thread without a lock, also while another
+  // thread reads a file, since files are only ever appended.
+  bool HasCodeInFiles(const Key& key) const;
+  Vector<const char> GetCodeFromFiles(
+      const Key& key, const SavedConstantPool** constants = nullptr) const;
+
+  // Appends the start positions of the functions of the script with
+  // |source_hash| that have blocks entered by calls, in ascending order.
+  // Removed blocks are left out.
+  void GetStartPositions(int source_hash, List<int>* start_positions) const;
+
+  SavedConstantPool* NewConstants(int owner = 0);
+
+  // Starts verifying the checksums of the blocks read from files on
+  // background threads.  GetCode only has to verify the blocks that haven't
+  // been reached yet.
+  void VerifyInBackground();
+  // Like VerifyInBackground, but only for the blocks of |keys| that were
+  // read from files, e.g. those about to be looked up one after another.
+  void VerifyInBackground(const List<Key>& keys);
 
  private:
+  class VerificationTask;
+  class KeysVerificationTask;
+
+  static const uint32_t kMagicNumber = 0x4c434442;  // "LCDB"
+  static const uint32_t kFormatVersion = 11;
+
+  struct Header {
+    uint32_t magic_number;
+    uint32_t format_version;
+    uint32_t version_hash;  // Version::Hash
+    uint32_t flag_hash;  // FlagList::Hash
+    uint32_t cpu_features;  // CpuFeatures::SupportedFeatures
+    uint32_t number_of_blocks;
+    uint32_t number_of_pools;
+    uint32_t generation;  // The largest generation in the index.
+
+    // The header a file saved by this process would have, apart from the
+    // counts and the generation.
+    static Header Current();
+
+    // Returns the reason why a file with this header can't be loaded, or
+    // nullptr if it can.
+    const char* Mismatch() const;
+  };
+
+  struct PoolEntry {
+    uint32_t offset;  // From the beginning of the file.
+    uint32_t size;
+    uint32_t checksum;
+  };
+
+  struct IndexEntry {
+    int32_t source_hash;
+    int32_t start_position;
+    int32_t osr_ast_id;
+    uint32_t offset;  // From the beginning of the file.
+    uint32_t size;
+    uint32_t checksum;
+    uint32_t pool;  // Index of the PoolEntry.
+    // Incremented by every write, so that the blocks of later runs have
+    // larger generations.
+    uint32_t generation;
+    uint32_t deopt_count;  // See Profile.
+    uint32_t inlined_functions;
+
+    Key GetKey() const {
+      return Key(source_hash, start_position, osr_ast_id);
+    }
+
+    // Whether the policy keeps this block rather than |other|.
+    bool Replaces(const IndexEntry& other, MergePolicy policy) const;
+  };
+
+  // Whether a block read from a file can be used.  Accessed concurrently by
+  // the main thread and the verification tasks.
+  enum BlockState {
+    kUnverified = 0,
+    kValid,
+    kDamaged
+  };
+
+  // A file we have read from.  It is mapped if possible, otherwise it is
+  // read into |buffer|.  Files are allocated once they have been checked and
+  // stay where they are until the database is destroyed, so lookups and the
+  // verification tasks can hold on to them.
+  struct File {
+    base::OS::MemoryMappedFile* mapping;
+    Vector<const char> buffer;
+    bool owns_buffer;  // Whether the buffer is freed along with the file.
+    const IndexEntry* index;
+    int number_of_blocks;
+    base::Atomic32* states;  // BlockState of each index entry.
+    SavedConstantPool** pools;
+    int number_of_pools;
+    uint32_t generation;
+    base::AtomicWord next;  // The File read after this one, or 0.
+
+    const File* next_file() const {
+      return reinterpret_cast<const File*>(base::Acquire_Load(&next));
+    }
+
+    // Frees everything but the file itself.
+    void Dispose();
+
+    // Binary search in the index.
+    const IndexEntry* FindIndexEntry(const Key& key) const;
+    // The first entry whose key is not less than |key|, or the end of the
+    // index.
+    const IndexEntry* LowerBound(const Key& key) const;
+
+    // Returns an empty vector if the entry points outside of the file or the
+    // checksum doesn't match.
+    Vector<const char> GetCode(const IndexEntry* entry) const;
+
+    BlockState Verify(const IndexEntry* entry) const;
+  };
+
   class CodeBlock {
    public:
-    CodeBlock(int start_position,
+    CodeBlock(const Key& key,
               Vector<const char> code,
+              Profile profile,
+              const SavedConstantPool* constants,
               bool managed)
         : managed_(managed),
-          start_position_(start_position),
-          code_(code) {}
+          key_(key),
+          code_(code),
+          profile_(profile),
+          constants_(constants) {}
 
-    int StartPosition() const { return start_position_; }
-    Vector<const char> Code() const { return code_; }
+    ~CodeBlock() { DisposeIfNeeded(); }
 
-    void SetCode(Vector<const char> code, bool managed) {
-      DisposeIfNeeded();
-      managed_ = managed;
-      code_ = code;
-    }
+    const Key* GetKey() const { return &key_; }
+    Vector<const char> Code() const { return code_; }
+    Profile GetProfile() const { return profile_; }
+    const SavedConstantPool* Constants() const { return constants_; }
 
     void DisposeIfNeeded() {
       if (managed_) {
@@ -58,15 +398,63 @@ class CodeBlockDatabase {
       }
     }
 
+    static bool Match(void* key1, void* key2) {
+      return *static_cast<Key*>(key1) == *static_cast<Key*>(key2);
+    }
+
    private:
     bool managed_;
-    int start_position_;
+    Key key_;
     Vector<const char> code_;
+    Profile profile_;
+    const SavedConstantPool* constants_;
+
+    DISALLOW_COPY_AND_ASSIGN(CodeBlock);
   };
 
+  // Reads every file and every database in every directory listed in
+  // |source|.
+  void Open(const char* source);
+
+  // Checks the contents of |file| and appends it to the files, or disposes
+  // of it.  |name| is for tracing.
+  bool Add(File file, const char* name);
+
+  CodeBlock* FindCodeBlock(const Key& key) const;
+  const IndexEntry* FindIndexEntry(const Key& key,
+                                   const File** file) const;
+
+  // The files in the order they were read, see File::next_file.
+  const File* first_file() const {
+    return reinterpret_cast<const File*>(base::Acquire_Load(&first_file_));
+  }
+
+  static uint32_t Checksum(Vector<const char> code);
+
+  // Stops the verification tasks and waits for them to finish.
+  void AbortVerification();
+
   const char* source_;
-  List<CodeBlock> code_blocks_;
-  Vector<const char> buffer_;
+
+  // Blocks added during this run, keyed by Key.  Mutable because
+  // HashMap::Lookup is not const even when nothing is inserted.
+  mutable HashMap code_blocks_;
+  // Blocks removed or replaced during this run, see RemoveCode.
+  List<CodeBlock*> retired_code_blocks_;
+
+  // A list that lookups walk without a lock: a File is published by a
+  // release store to |first_file_| or to the |next| of |last_file_|.
+  base::AtomicWord first_file_;
+  File* last_file_;
+  // Keys of the blocks read from files that must not be written.
+  std::set<Key> removed_keys_;
+
+  // The pools of the blocks added during this run, by owner.
+  std::map<int, SavedConstantPool*> new_constants_;
+
+  base::Atomic32 verification_aborted_;
+  int pending_verification_tasks_;
+  base::Semaphore verification_tasks_semaphore_;
 
   DISALLOW_COPY_AND_ASSIGN(CodeBlockDatabase);
 };
@@ -20,10 +20,14 @@
 #include "src/hydrogen.h"
 #include "src/isolate-inl.h"
 #include "src/lithium.h"
+#include "src/lithium-validator.h"
 #include "src/liveedit.h"
 #include "src/parser.h"
 #include "src/rewriter.h"
 #include "src/runtime-profiler.h"
+#include "src/saved-deopt-profile.h"
+#include "src/saveload-report.h"
+#include "src/saved-type-feedback.h"
 #include "src/scanner-character-streams.h"
 #include "src/scopeinfo.h"
 #include "src/scopes.h"
@@ -159,6 +163,7 @@ void CompilationInfo::Initialize(Isolate* isolate,
                    ? new List<OffsetRange>(2) : NULL;
   for (int i = 0; i < DependentCode::kGroupCount; i++) {
     dependencies_[i] = NULL;
+    committed_dependencies_[i] = NULL;
   }
   if (mode == STUB) {
     mode_ = STUB;
@@ -225,6 +230,7 @@ void CompilationInfo::CommitDependencies(Handle<Code> code) {
           DependentCode::ForObject(group_objects->at(j), group);
       dependent_code->UpdateToFinishedCode(group, this, *code);
     }
+    committed_dependencies_[i] = group_objects;
     dependencies_[i] = NULL;  // Zone-allocated, no need to delete.
   }
 }
@@ -491,7 +497,9 @@ OptimizedCompileJob::Status OptimizedCompileJob::SaveChunk(LSavedChunk* saved_ch
   if (Script::cast(info()->shared_info()->script())->compilation_type() !=
       Script::COMPILATION_TYPE_HOST) {
     reason = "eval";
-  } else if (!saved_chunk->Save(chunk_)) {
+  } else if (info()->code()->is_turbofanned()
+                 ? !saved_chunk->SaveCode(info(), info()->code())
+                 : !saved_chunk->Save(chunk_, info()->code())) {
     reason = saved_chunk->Reason();
   } else {
     return SUCCEEDED;
@@ -528,11 +536,36 @@ OptimizedCompileJob::Status OptimizedCompileJob::LoadChunk(const LSavedChunk* sa
 }
 
 
+OptimizedCompileJob::Status OptimizedCompileJob::LoadCode(
+    const LSavedChunk* saved_chunk) {
+  DCHECK(chunk_ == NULL);
+  Handle<Code> code = saved_chunk->LoadCode(info());
+
+  if (!code.is_null()) {
+    info()->SetCode(code);
+    if (FLAG_trace_saveload) {
+      PrintF("[machine code for %d loaded]\n",
+             info()->shared_info()->start_position());
+    }
+    return SetLastStatus(SUCCEEDED);
+  }
+
+  if (FLAG_trace_saveload && saved_chunk->Reason()) {
+    PrintF("[machine code for %d failed to load, reason: %s]\n",
+           info()->shared_info()->start_position(), saved_chunk->Reason());
+  }
+
+  // Don't SetLastStatus: the Lithium chunk may still be loaded instead.
+  return FAILED;
+}
+
+
 OptimizedCompileJob::Status OptimizedCompileJob::GenerateCode() {
   DCHECK(last_status() == SUCCEEDED);
   // TODO(turbofan): Currently everything is done in the first phase.
+  // Crankshaft code gets here when it was loaded as machine code.
   if (!info()->code().is_null()) {
-    if (FLAG_turbo_deoptimization) {
+    if (FLAG_turbo_deoptimization || !info()->code()->is_turbofanned()) {
       info()->context()->native_context()->AddOptimizedCode(*info()->code());
     }
     RecordOptimizationStats();
@@ -839,16 +872,100 @@ static bool GenerateOptimizedCode(OptimizedCompileJob job) {
 }
 
 
+// Isolates on several threads may use the database at once, e.g. in aotc.
+// Saving also adds to the constant pool of the saving isolate.  Only the
+// files read are looked up without it, see CodeBlockDatabase.
+static base::LazyMutex code_block_database_mutex = LAZY_MUTEX_INITIALIZER;
+
+
+static CodeBlockDatabase::Key CodeBlockKey(
+    Script* script, int start_position,
+    BailoutId osr_ast_id = BailoutId::None()) {
+  return CodeBlockDatabase::Key(script->GetSourceHash(), start_position,
+                                osr_ast_id.ToInt());
+}
+
+
+bool Compiler::HasSavedCode(Script* script, int start_position,
+                            BailoutId osr_ast_id) {
+  CodeBlockDatabase::Key key = CodeBlockKey(script, start_position,
+                                            osr_ast_id);
+  if (!IsSavingCode()) {
+    return code_block_database->HasCodeInFiles(key);
+  }
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  return code_block_database->HasCode(key);
+}
+
+
+Vector<const char> Compiler::GetSavedCode(
+    Script* script, int start_position, BailoutId osr_ast_id,
+    const SavedConstantPool** constants) {
+  CodeBlockDatabase::Key key = CodeBlockKey(script, start_position,
+                                            osr_ast_id);
+  if (!IsSavingCode()) {
+    return code_block_database->GetCodeFromFiles(key, constants);
+  }
+  // The lock is not held while loading, which may deoptimize other code
+  // and so remove blocks.  Blocks saved during this run stay valid until
+  // the database is destroyed, and their pool is safe to read concurrently.
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  return code_block_database->GetCode(key, constants);
+}
+
+
+// What the merge policy of the database compares saved code by.
+static CodeBlockDatabase::Profile CodeBlockProfile(CompilationInfo* info) {
+  CodeBlockDatabase::Profile profile = {
+    static_cast<uint32_t>(info->shared_info()->deopt_count()), 0 };
+  FixedArray* deoptimization_data = info->code()->deoptimization_data();
+  if (deoptimization_data->length() > 0) {
+    profile.inlined_functions = static_cast<uint32_t>(
+        DeoptimizationInputData::cast(deoptimization_data)
+            ->InlinedFunctionCount()->value());
+  }
+  return profile;
+}
+
+
+bool Compiler::WillSaveOptimizedCode(CompilationInfo* info) {
+  // Stubs have no closure.
+  if (!IsSavingCode() || info->closure().is_null() ||
+      !info->closure()->PassesFilter(FLAG_saveload_filter)) {
+    return false;
+  }
+  Object* script = info->shared_info()->script();
+  return script->IsScript() &&
+         Script::cast(script)->type()->value() == Script::TYPE_NORMAL &&
+         Script::cast(script)->compilation_type() ==
+             Script::COMPILATION_TYPE_HOST;
+}
+
+
 bool Compiler::SaveOptimizedCode(CompilationInfo* info) {
   TimerEventScope<TimerEventSaveload> timer(info->isolate());
   OptimizedCompileJob job(info);
 
   Script* script = Script::cast(info->shared_info()->script());
   if (script->type()->value() == Script::TYPE_NORMAL) {
-    LSavedChunk chunk;
+    base::LockGuard<base::Mutex> lock_guard(
+        code_block_database_mutex.Pointer());
+    Counters* counters = info->isolate()->counters();
+    // A pool per isolate, so that which constants a pool gets doesn't depend
+    // on how the isolates interleave.
+    int owner = info->isolate()->id();
+    LSavedChunk chunk(code_block_database->NewConstants(owner));
     if (job.SaveChunk(&chunk) == OptimizedCompileJob::SUCCEEDED) {
       Vector<const char> code = chunk.GetCode();
-      code_block_database->SetCode(info->function()->start_position(), code);
+      code_block_database->SetCode(
+          CodeBlockKey(script, info->function()->start_position(),
+                       info->osr_ast_id()),
+          code, CodeBlockProfile(info), owner);
+      counters->saveload_chunks_saved()->Increment();
+      counters->saveload_bytes_saved()->Increment(code.length());
+      if (!report.is_empty()) {
+        report->RecordSaved(info, code.length());
+      }
 
       if (FLAG_trace_saveload) {
         PrintF("[optimized code for %d saved, size=%d]\n",
@@ -856,28 +973,161 @@ bool Compiler::SaveOptimizedCode(CompilationInfo* info) {
       }
       return true;
     }
+
+    counters->saveload_chunks_not_saved()->Increment();
+    if (!report.is_empty()) {
+      // SaveChunk turns down eval code without trying to save it.
+      report->RecordNotSaved(info, chunk.Reason() ? chunk.Reason() : "eval");
+    }
   }
 
   return false;
 }
 
 
+// Runs on the main thread, also with --concurrent-recompilation: the chunk
+// loader creates handles and maps while it decodes the instructions, so
+// none of the loading can move to the OptimizingCompilerThread.  Only the
+// checksums are verified in the background (see VerifyInBackground).
 bool Compiler::LoadOptimizedCode(CompilationInfo* info) {
   TimerEventScope<TimerEventSaveload> timer(info->isolate());
   OptimizedCompileJob job(info);
 
-  int start_position = info->shared_info()->start_position();
-  Vector<const char> code = code_block_database->GetCode(start_position);
-  LSavedChunk chunk(code);
-
-  bool status = job.LoadChunk(&chunk) == OptimizedCompileJob::SUCCEEDED
-    && GenerateOptimizedCode(job);
+  const SavedConstantPool* constants;
+  Vector<const char> code =
+      GetSavedCode(*info->script(), info->shared_info()->start_position(),
+                   info->osr_ast_id(), &constants);
+  Counters* counters = info->isolate()->counters();
+  if (code.is_empty()) {
+    // The block either failed its checksum, or it was saved during this run
+    // and removed since HasSavedCode found it, e.g. because its code was
+    // deoptimized in another context.
+    const char* reason;
+    if (HasSavedCode(*info->script(), info->shared_info()->start_position(),
+                     info->osr_ast_id())) {
+      counters->saveload_load_failed_damaged()->Increment();
+      reason = "damaged";
+    } else {
+      counters->saveload_load_failed_removed()->Increment();
+      reason = "removed";
+    }
+    if (!report.is_empty()) {
+      report->RecordLoadFailed(info, 0, base::TimeDelta(), reason);
+    }
+    return false;
+  }
+  counters->saveload_bytes_loaded()->Increment(code.length());
+  LSavedChunk chunk(code, constants);
+
+  // Prefer the machine code, which doesn't need code generation, unless the
+  // chunk is to be validated.  TurboFan code only has machine code.
+  base::ElapsedTimer load_timer;
+  load_timer.Start();
+  bool has_lithium = chunk.HasLithium();
+  bool machine_code =
+      (!has_lithium ||
+       (FLAG_saveload_machine_code && !FLAG_saveload_validate)) &&
+      job.LoadCode(&chunk) == OptimizedCompileJob::SUCCEEDED;
+  bool loaded =
+      machine_code ||
+      (has_lithium &&
+       job.LoadChunk(&chunk) == OptimizedCompileJob::SUCCEEDED);
+  base::TimeDelta load_time = load_timer.Elapsed();
+  counters->saveload_load_time_us()->Increment(
+      static_cast<int>(load_time.InMicroseconds()));
+  if (!loaded) {
+    counters->saveload_load_failed_chunk()->Increment();
+    if (!report.is_empty()) {
+      report->RecordLoadFailed(info, code.length(), load_time,
+                               chunk.Reason());
+    }
+    return false;
+  }
+  if (FLAG_saveload_validate && !machine_code) {
+    ValidateLoadedChunk(info, job.chunk());
+  }
+
+  base::ElapsedTimer codegen_timer;
+  codegen_timer.Start();
+  bool status = GenerateOptimizedCode(job);
+  base::TimeDelta codegen_time = codegen_timer.Elapsed();
+  counters->saveload_codegen_time_us()->Increment(
+      static_cast<int>(codegen_time.InMicroseconds()));
+  if (!status) {
+    counters->saveload_load_failed_codegen()->Increment();
+    if (!report.is_empty()) {
+      report->RecordLoadFailed(info, code.length(), load_time,
+                               GetBailoutReason(info->bailout_reason()));
+    }
+    return false;
+  }
+  // Deoptimizations are attributed to loaded code by this mark.
+  info->code()->set_is_loaded_code(true);
 
-  if (status && FLAG_trace_saveload) {
+  if (machine_code) {
+    counters->saveload_machine_code_loaded()->Increment();
+  } else {
+    counters->saveload_chunks_loaded()->Increment();
+  }
+  if (!report.is_empty()) {
+    report->RecordLoaded(info, code.length(), load_time, codegen_time);
+  }
+  if (FLAG_trace_saveload) {
     PrintF("[optimized code for %d loaded]\n",
            info->shared_info()->start_position());
   }
-  return status;
+  return true;
+}
+
+
+void Compiler::ValidateLoadedChunk(CompilationInfo* info, LChunk* loaded) {
+  Isolate* isolate = info->isolate();
+  HandleScope scope(isolate);
+  CompilationInfoWithZone fresh_info(info->closure());
+  fresh_info.SetOptimizing(info->osr_ast_id(), info->unoptimized_code());
+  OptimizedCompileJob fresh_job(&fresh_info);
+  // The code of the fresh chunk is never generated, so its dependencies are
+  // rolled back along with |fresh_info|.
+  if (!ParseAndAnalyze(&fresh_info) ||
+      fresh_job.CreateGraph() != OptimizedCompileJob::SUCCEEDED ||
+      fresh_job.OptimizeGraph() != OptimizedCompileJob::SUCCEEDED ||
+      fresh_job.chunk() == NULL) {
+    if (isolate->has_pending_exception()) {
+      isolate->clear_pending_exception();
+    }
+    // The loaded code is used regardless, and validating it should not
+    // change what happens to the function.
+    fresh_info.KeepFutureOptimization();
+    if (FLAG_trace_saveload) {
+      PrintF("[optimized code for %d not validated, reason: %s]\n",
+             info->shared_info()->start_position(),
+             GetBailoutReason(fresh_info.bailout_reason()));
+    }
+    return;
+  }
+
+  Counters* counters = isolate->counters();
+  counters->saveload_chunks_validated()->Increment();
+  LChunkValidator validator(fresh_job.chunk(), loaded);
+  if (validator.Validate()) {
+    if (FLAG_trace_saveload) {
+      PrintF("[optimized code for %d validated]\n",
+             info->shared_info()->start_position());
+    }
+    return;
+  }
+
+  counters->saveload_validation_mismatches()->Increment();
+  if (!report.is_empty()) {
+    report->RecordMismatch(info, validator.Reason());
+  }
+  // Printed without --trace-saveload, since finding these is the point.
+  SmartArrayPointer<char> name = info->shared_info()->DebugName()->ToCString();
+  PrintF("[optimized code for %s (%d) does not match a fresh compile at "
+         "instruction %d (%s, loaded %s), reason: %s]\n",
+         name.get(), info->shared_info()->start_position(),
+         validator.InstructionIndex(), validator.ExpectedMnemonic(),
+         validator.ActualMnemonic(), validator.Reason());
 }
 
 
@@ -891,13 +1141,20 @@ bool Compiler::MakeOptimizedCode(CompilationInfo* info) {
 }
 
 
+static bool AllowSaveload(CompilationInfo* info) {
+  return (Compiler::IsSavingCode() || Compiler::IsLoadingCode()) &&
+     info->closure()->PassesFilter(FLAG_saveload_filter);
+}
+
+
 bool Compiler::GetOptimizedCodeNow(CompilationInfo* info) {
   if (!ParseAndAnalyze(info)) return false;
 
-  bool allow_saveload = (FLAG_save_code || FLAG_load_code) &&
-     info->closure()->PassesFilter(FLAG_saveload_filter);
+  bool allow_saveload = AllowSaveload(info);
 
-  if (allow_saveload && info->shared_info()->has_saved_optimized_code()) {
+  // Saved code for OSR has been tried by GetSavedCodeForOSR.
+  if (allow_saveload && !info->is_osr() &&
+      info->shared_info()->has_saved_optimized_code()) {
     if (!LoadOptimizedCode(info)) {
       info->shared_info()->set_has_saved_optimized_code(false);
 
@@ -912,7 +1169,7 @@ bool Compiler::GetOptimizedCodeNow(CompilationInfo* info) {
 
   if (!MakeOptimizedCode(info)) return false;
 
-  if (allow_saveload && FLAG_save_code) {
+  if (allow_saveload && IsSavingCode()) {
     SaveOptimizedCode(info);
   }
 
@@ -1459,10 +1716,11 @@ Handle<SharedFunctionInfo> Compiler::BuildFunctionInfo(
     DCHECK(allow_lazy);
   }
 
-  bool has_saved_optimized_code =
-    script->type()->value() == Script::TYPE_NORMAL &&
-    FLAG_load_code &&
-    code_block_database->HasCode(literal->start_position());
+  bool has_saved_optimized_code = false;
+  if (script->type()->value() == Script::TYPE_NORMAL && IsLoadingCode()) {
+    has_saved_optimized_code =
+        HasSavedCode(*script, literal->start_position());
+  }
 
   Handle<ScopeInfo> scope_info(ScopeInfo::Empty(isolate));
 
@@ -1542,9 +1800,18 @@ MaybeHandle<Code> Compiler::GetOptimizedCode(Handle<JSFunction> function,
   }
   current_code->set_profiler_ticks(0);
 
+  if (!osr_ast_id.IsNone() &&
+      GetSavedCodeForOSR(function, current_code, osr_ast_id)
+          .ToHandle(&cached_code)) {
+    return cached_code;
+  }
+
   info->SetOptimizing(osr_ast_id, current_code);
 
-  if (mode == CONCURRENT) {
+  // Saved code is loaded right away, which is cheaper than queueing a job.
+  bool has_saved_code = osr_ast_id.IsNone() && IsLoadingCode() &&
+                        shared->has_saved_optimized_code();
+  if (mode == CONCURRENT && !has_saved_code) {
     if (GetOptimizedCodeLater(info.get())) {
       info.Detach();  // The background recompile job owns this now.
       return isolate->builtins()->InOptimizationQueue();
@@ -1558,6 +1825,36 @@ MaybeHandle<Code> Compiler::GetOptimizedCode(Handle<JSFunction> function,
 }
 
 
+MaybeHandle<Code> Compiler::GetSavedCodeForOSR(Handle<JSFunction> function,
+                                               Handle<Code> current_code,
+                                               BailoutId osr_ast_id) {
+  Handle<SharedFunctionInfo> shared(function->shared());
+  if (!IsLoadingCode() || !shared->script()->IsScript()) {
+    return MaybeHandle<Code>();
+  }
+  Script* script = Script::cast(shared->script());
+  if (script->type()->value() != Script::TYPE_NORMAL) {
+    return MaybeHandle<Code>();
+  }
+  if (!HasSavedCode(script, shared->start_position(), osr_ast_id)) {
+    return MaybeHandle<Code>();
+  }
+
+  // A separate compilation, so that the caller can still compile the usual
+  // way if loading fails.
+  CompilationInfoWithZone info(function);
+  info.SetOptimizing(osr_ast_id, current_code);
+  if (AllowSaveload(&info) && ParseAndAnalyze(&info) &&
+      LoadOptimizedCode(&info)) {
+    return info.code();
+  }
+
+  Isolate* isolate = info.isolate();
+  if (isolate->has_pending_exception()) isolate->clear_pending_exception();
+  return MaybeHandle<Code>();
+}
+
+
 Handle<Code> Compiler::GetConcurrentlyOptimizedCode(OptimizedCompileJob* job) {
   // Take ownership of compilation info.  Deleting compilation info
   // also tears down the zone and the recompile job.
@@ -1589,6 +1886,11 @@ Handle<Code> Compiler::GetConcurrentlyOptimizedCode(OptimizedCompileJob* job) {
               info->context()->native_context(), info->osr_ast_id()) == -1) {
         InsertCodeIntoOptimizedCodeMap(info.get());
       }
+      // The chunk is still alive, so the code can be saved just as if it
+      // was compiled synchronously.
+      if (IsSavingCode() && AllowSaveload(info.get())) {
+        SaveOptimizedCode(info.get());
+      }
       if (FLAG_trace_opt) {
         PrintF("[completed optimizing ");
         info->closure()->ShortPrint();
@@ -1649,29 +1951,232 @@ bool CompilationPhase::ShouldProduceTraceOutput() const {
 
 
 SmartPointer<CodeBlockDatabase> Compiler::code_block_database;
+bool Compiler::collecting_code = false;
+bool Compiler::added_code = false;
+SmartPointer<SavedDeoptProfile> Compiler::deopt_profile;
+SmartPointer<SavedTypeFeedback> Compiler::type_feedback;
+SmartPointer<SaveloadReport> Compiler::report;
+
+
+// Returns false if |function| has saved code that can't be installed yet.
+static bool PrewarmFunction(Handle<JSFunction> function, bool* installed) {
+  Isolate* isolate = function->GetIsolate();
+  Handle<SharedFunctionInfo> shared(function->shared());
+  *installed = false;
+  if (!shared->has_saved_optimized_code() || function->IsOptimized() ||
+      function->IsInOptimizationQueue() || shared->optimization_disabled() ||
+      !isolate->use_crankshaft() || isolate->DebuggerHasBreakPoints()) {
+    return true;
+  }
+
+  Handle<Code> code;
+  Handle<Code> current_code(shared->code());
+  if (!Compiler::GetOptimizedCode(function, current_code,
+                                  Compiler::NOT_CONCURRENT).ToHandle(&code)) {
+    // The code may refer to functions that haven't been created yet.  Leave
+    // it to be loaded on the first call then.
+    shared->set_has_saved_optimized_code(true);
+    return false;
+  }
+  function->ReplaceCode(*code);
+  *installed = true;
+  return true;
+}
+
+
+void Compiler::PrewarmSavedOptimizedCode(Isolate* isolate,
+                                         Handle<Script> script) {
+  DCHECK(IsLoadingCode());
+  HandleScope scope(isolate);
+  int source_hash = script->GetSourceHash();
+  List<int> start_positions;
+  code_block_database->GetStartPositions(source_hash, &start_positions);
+
+  // Only top-level functions exist yet, the others are prewarmed as their
+  // closures are created.
+  List<Handle<JSFunction> > functions;
+  List<CodeBlockDatabase::Key> keys;
+  for (int start_position: start_positions) {
+    Handle<JSFunction> function =
+        isolate->GetJSFunctionByStartPosition(source_hash, start_position);
+    if (!function.is_null()) {
+      functions.Add(function);
+      keys.Add(CodeBlockDatabase::Key(source_hash, start_position));
+    }
+  }
+
+  // The blocks are decoded on this thread, but their checksums can be
+  // verified ahead of it on another.
+  if (FLAG_concurrent_recompilation) {
+    code_block_database->VerifyInBackground(keys);
+  }
+
+  int prewarmed = 0;
+  int postponed = 0;
+  for (Handle<JSFunction> function: functions) {
+    bool installed;
+    if (!PrewarmFunction(function, &installed)) {
+      postponed++;
+    } else if (installed) {
+      prewarmed++;
+    }
+  }
+
+  if (FLAG_trace_saveload) {
+    PrintF("[prewarmed saved code for %d of %d functions, %d postponed]\n",
+           prewarmed, start_positions.length(), postponed);
+  }
+}
+
+
+void Compiler::PrewarmSavedOptimizedCode(Handle<JSFunction> function) {
+  if (!IsLoadingCode() || !FLAG_saveload_prewarm ||
+      !function->shared()->has_saved_optimized_code()) {
+    return;
+  }
+  bool installed;
+  PrewarmFunction(function, &installed);
+  if (FLAG_trace_saveload && installed) {
+    PrintF("[prewarmed saved code for %d]\n",
+           function->shared()->start_position());
+  }
+}
 
 
 void Compiler::InitializeCodeBlockDatabase() {
   DCHECK(FLAG_save_code || FLAG_load_code);
   CodeBlockDatabase* db;
-  if (FLAG_save_code) {
-    db = new CodeBlockDatabase;
-  } else { // FLAG_load_code
+  if (FLAG_load_code) {
+    // With --save-code too, the loaded code is merged into the saved file.
     db = new CodeBlockDatabase(FLAG_load_code);
+    // Keep checksum verification off the main thread if we may use threads.
+    // The chunks themselves are still decoded on the main thread.
+    if (FLAG_concurrent_recompilation) {
+      db->VerifyInBackground();
+    }
+  } else {
+    db = new CodeBlockDatabase;
   }
   code_block_database = SmartPointer<CodeBlockDatabase>(db);
+
+  if (FLAG_saveload_deopt_profile) {
+    deopt_profile = SmartPointer<SavedDeoptProfile>(
+        new SavedDeoptProfile(FLAG_saveload_deopt_profile));
+  }
 }
 
 
-bool Compiler::DiscardCodeFromCodeBlockDatabase(int start_position) {
-  DCHECK(FLAG_save_code);
-  return code_block_database->RemoveCode(start_position);
+bool Compiler::DiscardCodeFromCodeBlockDatabase(SharedFunctionInfo* shared) {
+  DCHECK(IsSavingCode());
+  if (!shared->script()->IsScript()) {
+    return false;
+  }
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  return code_block_database->RemoveCode(
+      CodeBlockKey(Script::cast(shared->script()), shared->start_position()));
+}
+
+
+static CodeBlockDatabase::MergePolicy MergePolicyFromFlag() {
+  CodeBlockDatabase::MergePolicy policy;
+  if (!CodeBlockDatabase::ParseMergePolicy(FLAG_saveload_merge_policy,
+                                           &policy)) {
+    PrintF("[unknown --saveload-merge-policy \"%s\", keeping the newest "
+           "code]\n", FLAG_saveload_merge_policy);
+    policy = CodeBlockDatabase::kNewest;
+  }
+  return policy;
+}
+
+
+bool Compiler::AddSavedCode(Vector<const char> data, bool embedded) {
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  if (code_block_database.is_empty()) {
+    code_block_database =
+        SmartPointer<CodeBlockDatabase>(new CodeBlockDatabase);
+  }
+  if (embedded ? !code_block_database->ReadEmbedded(data)
+               : !code_block_database->Read(data)) {
+    return false;
+  }
+  added_code = true;
+  return true;
+}
+
+
+void Compiler::CollectSavedCode() {
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  if (code_block_database.is_empty()) {
+    code_block_database =
+        SmartPointer<CodeBlockDatabase>(new CodeBlockDatabase);
+  }
+  collecting_code = true;
+}
+
+
+void Compiler::StopCollectingSavedCode() {
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  collecting_code = false;
+}
+
+
+bool Compiler::ExportSavedCode(List<char>* data) {
+  base::LockGuard<base::Mutex> lock_guard(code_block_database_mutex.Pointer());
+  if (code_block_database.is_empty()) {
+    return false;
+  }
+  int number_of_blocks =
+      code_block_database->Write(data, MergePolicyFromFlag());
+  if (FLAG_trace_saveload) {
+    PrintF("[code block database exported, %d blocks, size=%d]\n",
+           number_of_blocks, data->length());
+  }
+  return true;
 }
 
 
 void Compiler::FinalizeCodeBlockDatabase() {
-  DCHECK(FLAG_save_code);
-  code_block_database->Write(FLAG_save_code);
+  DCHECK(IsSavingCode() || IsLoadingCode());
+  if (FLAG_save_code) {
+    code_block_database->Write(FLAG_save_code, MergePolicyFromFlag());
+  }
+  code_block_database.Reset(nullptr);
+
+  // Only runs that load code add to the profile.
+  if (!deopt_profile.is_empty() && IsLoadingCode()) {
+    deopt_profile->Write();
+  }
+  deopt_profile.Reset(nullptr);
+}
+
+
+void Compiler::InitializeSaveloadReport() {
+  DCHECK(FLAG_saveload_report);
+  report = SmartPointer<SaveloadReport>(
+      new SaveloadReport(FLAG_saveload_report));
+}
+
+
+void Compiler::FinalizeSaveloadReport() {
+  DCHECK(FLAG_saveload_report);
+  report->Write();
+  report.Reset(nullptr);
+}
+
+
+void Compiler::InitializeSavedTypeFeedback() {
+  DCHECK(FLAG_saveload_record_feedback || FLAG_saveload_replay_feedback);
+  type_feedback = SmartPointer<SavedTypeFeedback>(
+      new SavedTypeFeedback(FLAG_saveload_replay_feedback));
+}
+
+
+void Compiler::FinalizeSavedTypeFeedback() {
+  DCHECK(FLAG_saveload_record_feedback || FLAG_saveload_replay_feedback);
+  if (FLAG_saveload_record_feedback) {
+    type_feedback->Write(FLAG_saveload_record_feedback);
+  }
+  type_feedback.Reset(nullptr);
 }
 
 } }  // namespace v8::internal
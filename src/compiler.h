@@ -16,6 +16,10 @@ namespace internal {
 class AstValueFactory;
 class HydrogenCodeStub;
 class CodeBlockDatabase;
+class SavedConstantPool;
+class SavedDeoptProfile;
+class SavedTypeFeedback;
+class SaveloadReport;
 class LChunk;
 
 // ParseRestriction is used to restrict the set of valid statements in a
@@ -325,6 +329,13 @@ class CompilationInfo {
 
   void CommitDependencies(Handle<Code> code);
 
+  // The dependencies of the code once they have been committed, so that
+  // they can be saved along with it.
+  const ZoneList<Handle<HeapObject> >* committed_dependencies(
+      DependentCode::DependencyGroup group) const {
+    return committed_dependencies_[group];
+  }
+
   void RollbackDependencies();
 
   void SaveHandles() {
@@ -340,6 +351,10 @@ class CompilationInfo {
     SetFlag(kDisableFutureOptimization);
   }
 
+  // Keeps an aborted optimization from disabling that of the function, for
+  // compilations whose code is never used, see --saveload-validate.
+  void KeepFutureOptimization() { SetFlag(kDisableFutureOptimization, false); }
+
   void RetryOptimization(BailoutReason reason) {
     if (bailout_reason_ != kNoReason) bailout_reason_ = reason;
   }
@@ -491,6 +506,8 @@ class CompilationInfo {
   DeferredHandles* deferred_handles_;
 
   ZoneList<Handle<HeapObject> >* dependencies_[DependentCode::kGroupCount];
+  ZoneList<Handle<HeapObject> >*
+      committed_dependencies_[DependentCode::kGroupCount];
 
   template<typename T>
   void SaveHandle(Handle<T> *object) {
@@ -606,10 +623,13 @@ class OptimizedCompileJob: public ZoneObject {
   MUST_USE_RESULT Status OptimizeGraph();
   MUST_USE_RESULT Status SaveChunk(LSavedChunk*);
   MUST_USE_RESULT Status LoadChunk(const LSavedChunk*);
+  // Loads the saved machine code, if any, instead of the Lithium chunk.
+  MUST_USE_RESULT Status LoadCode(const LSavedChunk*);
   MUST_USE_RESULT Status GenerateCode();
 
   Status last_status() const { return last_status_; }
   CompilationInfo* info() const { return info_; }
+  LChunk* chunk() const { return chunk_; }
   Isolate* isolate() const { return info()->isolate(); }
 
   Status RetryOptimization(BailoutReason reason) {
@@ -738,17 +758,89 @@ class Compiler : public AllStatic {
   static bool DebuggerWantsEagerCompilation(
       CompilationInfo* info, bool allow_lazy_without_ctx = false);
 
+  // Installs saved optimized code for the functions of |script| that have
+  // blocks in the database, as one batch once the script has declared its
+  // top-level functions.  Functions whose code fails to load here are only
+  // tried again when they are first called.
+  static void PrewarmSavedOptimizedCode(Isolate* isolate,
+                                        Handle<Script> script);
+  // Installs saved optimized code for a closure as soon as it is created,
+  // with --saveload-prewarm, e.g. for inner functions and function
+  // expressions.
+  static void PrewarmSavedOptimizedCode(Handle<JSFunction> function);
+
   static void InitializeCodeBlockDatabase();
-  static bool DiscardCodeFromCodeBlockDatabase(int start_position);
+  static bool DiscardCodeFromCodeBlockDatabase(SharedFunctionInfo* shared);
   static void FinalizeCodeBlockDatabase();
 
+  // Whether optimized code is saved to the database, because of --save-code
+  // or because the embedder collects it.
+  static bool IsSavingCode() { return FLAG_save_code || collecting_code; }
+  // Whether SaveOptimizedCode will try to save the code compiled for |info|,
+  // so that the code generators can make it relocatable.
+  static bool WillSaveOptimizedCode(CompilationInfo* info);
+  // Whether functions look for optimized code in the database, because of
+  // --load-code or because the embedder added some.
+  static bool IsLoadingCode() { return FLAG_load_code || added_code; }
+
+  // Back v8::ScriptCompiler::AddOptimizedCode, CollectOptimizedCode,
+  // StopCollectingOptimizedCode and ExportOptimizedCode, which all act on
+  // the one database of the process.  |embedded| data is that of the
+  // snapshot, which is not copied.
+  static bool AddSavedCode(Vector<const char> data, bool embedded = false);
+  static void CollectSavedCode();
+  static void StopCollectingSavedCode();
+  // Appends the database to |data|.  Returns false if there is no database.
+  static bool ExportSavedCode(List<char>* data);
+
+  // Deoptimizations of loaded code, see --saveload-deopt-profile.  nullptr
+  // if there is no profile.
+  static SavedDeoptProfile* saved_deopt_profile() {
+    return deopt_profile.get();
+  }
+
+  // See --saveload-report.  nullptr if there is no report.
+  static void InitializeSaveloadReport();
+  static void FinalizeSaveloadReport();
+  static SaveloadReport* saveload_report() { return report.get(); }
+
+  // Recorded inline cache states, see --saveload-record-feedback and
+  // --saveload-replay-feedback.  nullptr if neither is given.
+  static void InitializeSavedTypeFeedback();
+  static void FinalizeSavedTypeFeedback();
+  static SavedTypeFeedback* saved_type_feedback() {
+    return type_feedback.get();
+  }
+
  private:
   static bool SaveOptimizedCode(CompilationInfo* info);
   static bool LoadOptimizedCode(CompilationInfo* info);
+  // Builds the chunk of |info| afresh and reports where |loaded| differs
+  // from it, see --saveload-validate.
+  static void ValidateLoadedChunk(CompilationInfo* info, LChunk* loaded);
+  // Returns an empty handle if there is no saved code for |osr_ast_id| or it
+  // fails to load.
+  static MaybeHandle<Code> GetSavedCodeForOSR(Handle<JSFunction> function,
+                                              Handle<Code> current_code,
+                                              BailoutId osr_ast_id);
   static bool GetOptimizedCodeNow(CompilationInfo* info);
   static bool MakeOptimizedCode(CompilationInfo* info);
 
+  // Look up the code block of a function in the database.  Only the blocks
+  // saved during this run need the database lock; the ones read from files
+  // are looked up by all isolates at once.
+  static bool HasSavedCode(Script* script, int start_position,
+                           BailoutId osr_ast_id = BailoutId::None());
+  static Vector<const char> GetSavedCode(Script* script, int start_position,
+                                         BailoutId osr_ast_id,
+                                         const SavedConstantPool** constants);
+
   static SmartPointer<CodeBlockDatabase> code_block_database;
+  static bool collecting_code;
+  static bool added_code;
+  static SmartPointer<SavedDeoptProfile> deopt_profile;
+  static SmartPointer<SavedTypeFeedback> type_feedback;
+  static SmartPointer<SaveloadReport> report;
 };
 
 
@@ -4,6 +4,7 @@
 
 #include "src/compiler/code-generator.h"
 
+#include "src/compiler.h"
 #include "src/compiler/code-generator-impl.h"
 #include "src/compiler/linkage.h"
 #include "src/compiler/pipeline.h"
@@ -31,6 +32,10 @@ CodeGenerator::CodeGenerator(Frame* frame, Linkage* linkage,
   for (int i = 0; i < code->InstructionBlockCount(); ++i) {
     new (&labels_[i]) Label;
   }
+  // Saved TurboFan code is always machine code; see LChunk::Codegen.
+  if (v8::internal::Compiler::WillSaveOptimizedCode(info)) {
+    masm_.set_predictable_code_size(true);
+  }
 }
 
 
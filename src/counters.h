@@ -521,6 +521,24 @@ class HistogramTimerScope BASE_EMBEDDED {
   SC(soft_deopts_requested, V8.SoftDeoptsRequested)                            \
   SC(soft_deopts_inserted, V8.SoftDeoptsInserted)                              \
   SC(soft_deopts_executed, V8.SoftDeoptsExecuted)                              \
+  /* Optimized code saved to and loaded from the code block database. */       \
+  SC(saveload_chunks_saved, V8.SaveloadChunksSaved)                            \
+  SC(saveload_chunks_not_saved, V8.SaveloadChunksNotSaved)                     \
+  SC(saveload_bytes_saved, V8.SaveloadBytesSaved)                              \
+  SC(saveload_chunks_loaded, V8.SaveloadChunksLoaded)                          \
+  SC(saveload_machine_code_loaded, V8.SaveloadMachineCodeLoaded)               \
+  SC(saveload_bytes_loaded, V8.SaveloadBytesLoaded)                            \
+  SC(saveload_load_failed_damaged, V8.SaveloadLoadFailedDamaged)               \
+  SC(saveload_load_failed_removed, V8.SaveloadLoadFailedRemoved)               \
+  SC(saveload_load_failed_chunk, V8.SaveloadLoadFailedChunk)                   \
+  SC(saveload_load_failed_codegen, V8.SaveloadLoadFailedCodegen)               \
+  SC(saveload_discarded_by_deopt, V8.SaveloadDiscardedByDeopt)                 \
+  SC(saveload_chunks_validated, V8.SaveloadChunksValidated)                    \
+  SC(saveload_validation_mismatches, V8.SaveloadValidationMismatches)          \
+  SC(saveload_detached_maps, V8.SaveloadDetachedMaps)                          \
+  /* Total microseconds spent loading chunks and generating their code. */     \
+  SC(saveload_load_time_us, V8.SaveloadLoadMicroseconds)                       \
+  SC(saveload_codegen_time_us, V8.SaveloadCodegenMicroseconds)                 \
   /* Number of write barriers in generated code. */                            \
   SC(write_barriers_dynamic, V8.WriteBarriersDynamic)                          \
   SC(write_barriers_static, V8.WriteBarriersStatic)                            \
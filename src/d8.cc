@@ -1760,14 +1760,6 @@ int Shell::Main(int argc, char* argv[]) {
     }
 #endif
 
-    if (i::FLAG_save_code || i::FLAG_load_code) {
-      if (i::FLAG_save_code && i::FLAG_load_code) {
-        printf("You can't set both --save-code and --load-code.\n");
-        return 1;
-      }
-      i::Compiler::InitializeCodeBlockDatabase();
-    }
-
     if (options.stress_opt || options.stress_deopt) {
       Testing::SetStressRunType(options.stress_opt
                                 ? Testing::kStressTypeOpt
@@ -1794,10 +1786,6 @@ int Shell::Main(int argc, char* argv[]) {
       result = RunMain(isolate, argc, argv);
     }
 
-    if (i::FLAG_save_code) {
-      i::Compiler::FinalizeCodeBlockDatabase();
-    }
-
     // Run interactive shell if explicitly requested or if no script has been
     // executed, but never on --test
     if (options.use_interactive_shell()) {
@@ -12,6 +12,8 @@
 #include "src/global-handles.h"
 #include "src/macro-assembler.h"
 #include "src/prettyprinter.h"
+#include "src/saved-deopt-profile.h"
+#include "src/saveload-report.h"
 
 
 namespace v8 {
@@ -779,6 +781,12 @@ void Deoptimizer::DoComputeOutputFrames() {
   }
 
   BailoutId node_id = input_data->AstId(bailout_id_);
+  SaveloadReport* report = Compiler::saveload_report();
+  if (report && bailout_type_ != DEBUGGER &&
+      compiled_code_->kind() == Code::OPTIMIZED_FUNCTION &&
+      compiled_code_->is_loaded_code()) {
+    report->RecordDeopt(function_->shared());
+  }
   ByteArray* translations = input_data->TranslationByteArray();
   unsigned translation_index =
       input_data->TranslationIndex(bailout_id_)->value();
@@ -847,6 +855,23 @@ void Deoptimizer::DoComputeOutputFrames() {
     }
   }
 
+  SavedDeoptProfile* deopt_profile = Compiler::saved_deopt_profile();
+  if (deopt_profile && bailout_type_ != DEBUGGER &&
+      compiled_code_->kind() == Code::OPTIMIZED_FUNCTION &&
+      compiled_code_->is_loaded_code()) {
+    // The bailout id belongs to the function of the innermost JavaScript
+    // frame, which may have been inlined.
+    JSFunction* inner = function_;
+    for (int i = output_count_ - 1; i >= 0; --i) {
+      if (output_[i]->GetFrameType() == StackFrame::JAVA_SCRIPT) {
+        inner = output_[i]->GetFunction();
+        break;
+      }
+    }
+    deopt_profile->Record(function_->shared(), inner->shared(), node_id,
+                          bailout_type_);
+  }
+
   // Print some helpful diagnostic information.
   if (trace_scope_ != NULL) {
     double ms = timer.Elapsed().InMillisecondsF();
@@ -860,6 +860,7 @@ Handle<Script> Factory::NewScript(Handle<String> source) {
   script->set_eval_from_shared(heap->undefined_value());
   script->set_eval_from_instructions_offset(Smi::FromInt(0));
   script->set_flags(Smi::FromInt(0));
+  script->set_source_hash(heap->undefined_value());
 
   return script;
 }
@@ -1376,16 +1377,7 @@ Handle<JSFunction> Factory::NewFunctionFromSharedFunctionInfo(
   Handle<Map> map(Map::cast(context->native_context()->get(map_index)));
   Handle<JSFunction> result = NewFunction(map, info, context, pretenure);
 
-  if (Script::cast(info->script())->type()->value() == Script::TYPE_NORMAL) {
-    // Can't preserve the local handle past enclosing handle scope.
-    auto function =
-      Handle<JSFunction>::cast(isolate()->global_handles()->Create(*result));
-    if (context->IsNativeContext()) {
-      // It won't work for other contexts. Don't even try.
-      isolate()->AddJSFunctionForStartPosition(info->start_position(),
-                                               function);
-    }
-  }
+  isolate()->AddJSFunctionForStartPosition(result);
 
   if (info->ic_age() != isolate()->heap()->global_ic_age()) {
     info->ResetForNewContext(isolate()->heap()->global_ic_age());
@@ -154,8 +154,40 @@ struct MaybeBoolFlag {
 
 // AOTC flags.
 DEFINE_STRING(saveload_filter, "*", "saveload filter")
-DEFINE_STRING(save_code, nullptr, "file to save generated code to")
-DEFINE_STRING(load_code, nullptr, "file to load generated code from")
+DEFINE_STRING(save_code, nullptr,
+              "file to save generated code to, along with the code loaded "
+              "with --load-code")
+DEFINE_STRING(load_code, nullptr,
+              "comma-separated files and directories to load generated "
+              "code from")
+DEFINE_BOOL(saveload_prewarm, false,
+            "install loaded code for functions as soon as their closures "
+            "are created, instead of on their first call")
+DEFINE_BOOL(saveload_machine_code, false,
+            "also save the generated machine code, so that loading can skip "
+            "code generation")
+DEFINE_STRING(saveload_deopt_profile, nullptr,
+              "file to record deoptimizations of loaded code in, so that "
+              "runs that save code can avoid them")
+DEFINE_INT(saveload_deopt_limit, 3,
+           "number of deoptimizations after which a function no longer "
+           "gets its loaded code back")
+DEFINE_STRING(saveload_merge_policy, "newest",
+              "which code to keep when --load-code and --save-code both have "
+              "code for a function: newest, fewest-deopts or most-inlining")
+DEFINE_STRING(saveload_record_feedback, nullptr,
+              "file to record the inline cache states of all functions to "
+              "when an isolate is disposed of, along with the states replayed "
+              "with --saveload-replay-feedback")
+DEFINE_STRING(saveload_replay_feedback, nullptr,
+              "file to replay recorded inline cache states from into newly "
+              "compiled full code")
+DEFINE_STRING(saveload_report, nullptr,
+              "file to write a table of the optimized code saved and loaded "
+              "for each function to at exit")
+DEFINE_BOOL(saveload_validate, false,
+            "also build the chunk of every function whose chunk is loaded, "
+            "and report where the two differ")
 
 // Flags for language modes and experimental language features.
 DEFINE_BOOL(use_strict, false, "enforce strict mode")
@@ -705,6 +737,17 @@ DEFINE_STRING(raw_context_file, NULL,
 DEFINE_STRING(startup_blob, NULL,
               "Write V8 startup blob file. "
               "(mksnapshot only)")
+DEFINE_STRING(embed_code, NULL,
+              "A code block database to embed in the snapshot, which is "
+              "loaded at startup as if with --load-code. (mksnapshot only)")
+
+// aotc.cc
+DEFINE_INT(aotc_jobs, 0,
+           "number of threads to compile on, 0 for the jobs of the manifest "
+           "(aotc only)")
+DEFINE_BOOL(aotc_runtime_profiler, true,
+            "let the runtime profiler optimize hot functions; aotc turns it "
+            "off while running its scripts")
 
 // code-stubs-hydrogen.cc
 DEFINE_BOOL(profile_hydrogen_code_stub_compilation, false,
@@ -756,7 +799,6 @@ DEFINE_IMPLICATION(saveload_dev, code_comments)
 DEFINE_IMPLICATION(saveload_dev, lithium_codegen_comments)
 
 DEFINE_BOOL(saveload_edge, false, "enable a bunch of flags for saveload development")
-DEFINE_NEG_IMPLICATION(saveload_edge, concurrent_recompilation)
 DEFINE_NEG_IMPLICATION(saveload_edge, concurrent_osr)
 DEFINE_IMPLICATION(saveload_edge, code_comments)
 DEFINE_IMPLICATION(saveload_edge, lithium_codegen_comments)
@@ -551,4 +551,35 @@ void FlagList::EnforceFlagImplications() {
 #undef FLAG_MODE_DEFINE_IMPLICATIONS
 }
 
+
+static bool FlagAffectsGeneratedCode(const Flag* flag) {
+  static const char* const kIgnoredPrefixes[] = {
+    "trace", "print", "log", "prof", "save_code", "load_code", "saveload",
+    "aotc", "random_seed", "testing_", "help", "js_arguments"
+  };
+  for (const char* prefix : kIgnoredPrefixes) {
+    if (strncmp(flag->name(), prefix, strlen(prefix)) == 0) return false;
+  }
+  return true;
+}
+
+
+// static
+uint32_t FlagList::Hash() {
+  std::ostringstream modified_flags;
+  for (size_t i = 0; i < num_flags; ++i) {
+    Flag* f = &flags[i];
+    if (!f->IsDefault() && FlagAffectsGeneratedCode(f)) {
+      modified_flags << "--" << f->name() << "=" << *f << " ";
+    }
+  }
+  std::string args = modified_flags.str();
+  uint32_t running_hash = 0;
+  for (char c : args) {
+    running_hash = StringHasher::AddCharacterCore(running_hash,
+                                                  static_cast<uint8_t>(c));
+  }
+  return StringHasher::GetHashCore(running_hash);
+}
+
 } }  // namespace v8::internal
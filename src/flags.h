@@ -57,6 +57,11 @@ class FlagList {
 
   // Set flags as consequence of being implied by another flag.
   static void EnforceFlagImplications();
+
+  // Hash of the flags that were changed from their defaults.  Flags that
+  // can't affect generated code, like tracing, are left out, so that code
+  // saved in one run can be checked against the flags of another.
+  static uint32_t Hash();
 };
 
 } }  // namespace v8::internal
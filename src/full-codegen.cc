@@ -14,6 +14,7 @@
 #include "src/liveedit.h"
 #include "src/macro-assembler.h"
 #include "src/prettyprinter.h"
+#include "src/saved-type-feedback.h"
 #include "src/scopeinfo.h"
 #include "src/scopes.h"
 #include "src/snapshot.h"
@@ -342,6 +343,9 @@ bool FullCodeGenerator::MakeCode(CompilationInfo* info) {
   code->set_back_edge_table_offset(table_offset);
   CodeGenerator::PrintCode(code, info);
   info->SetCode(code);
+  if (Compiler::saved_type_feedback() != nullptr) {
+    Compiler::saved_type_feedback()->Replay(info);
+  }
   void* line_info = masm.positions_recorder()->DetachJITHandlerData();
   LOG_CODE_EVENT(isolate, CodeEndLinePosInfoRecordEvent(*code, line_info));
 
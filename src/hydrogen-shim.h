@@ -69,6 +69,11 @@ class LChunkSaver;
   V(HWrapReceiverShim)                          \
   V(HInstanceOfKnownGlobalShim)                 \
   V(HTypeofIsAndBranchShim)                     \
+  V(HAllocateBlockContextShim)                  \
+  V(HCallStubShim)                              \
+  V(HSeqStringGetCharShim)                      \
+  V(HSeqStringSetCharShim)                      \
+  V(HTailCallThroughMegamorphicCacheShim)       \
 
 #define HYDROGEN_SHIM_LIST(V)                   \
   HYDROGEN_ABSTRACT_SHIM_LIST(V)                \
@@ -1670,6 +1675,102 @@ class HTypeofIsAndBranchShim : public HControlInstructionShim {
   Handle<String> type_literal_;
 };
 
+
+class HAllocateBlockContextShim : public HValueShim {
+ public:
+  DECLARE_SHIM(AllocateBlockContext)
+
+  explicit HAllocateBlockContextShim(HAllocateBlockContext* h)
+      : HValueShim(h),
+        scope_info_(h->scope_info()) {}
+
+  HAllocateBlockContextShim(HValueShim base, Handle<ScopeInfo> scope_info)
+      : HValueShim(base),
+        scope_info_(scope_info) {}
+
+  Handle<ScopeInfo> scope_info() const { return scope_info_; }
+
+ private:
+  Handle<ScopeInfo> scope_info_;
+};
+
+
+class HCallStubShim : public HCallShim {
+ public:
+  DECLARE_SHIM(CallStub)
+
+  explicit HCallStubShim(HCallStub* h)
+      : HCallShim(h),
+        major_key_(h->major_key()) {}
+
+  HCallStubShim(HCallShim base, CodeStub::Major major_key)
+      : HCallShim(base),
+        major_key_(major_key) {}
+
+  CodeStub::Major major_key() const { return major_key_; }
+
+ private:
+  CodeStub::Major major_key_;
+};
+
+
+class HSeqStringGetCharShim : public HValueShim {
+ public:
+  DECLARE_SHIM(SeqStringGetChar)
+
+  explicit HSeqStringGetCharShim(HSeqStringGetChar* h)
+      : HValueShim(h),
+        encoding_(h->encoding()) {}
+
+  HSeqStringGetCharShim(HValueShim base, String::Encoding encoding)
+      : HValueShim(base),
+        encoding_(encoding) {}
+
+  String::Encoding encoding() const { return encoding_; }
+
+ private:
+  String::Encoding encoding_;
+};
+
+
+class HSeqStringSetCharShim : public HValueShim {
+ public:
+  DECLARE_SHIM(SeqStringSetChar)
+
+  explicit HSeqStringSetCharShim(HSeqStringSetChar* h)
+      : HValueShim(h),
+        encoding_(h->encoding()) {}
+
+  HSeqStringSetCharShim(HValueShim base, String::Encoding encoding)
+      : HValueShim(base),
+        encoding_(encoding) {}
+
+  String::Encoding encoding() const { return encoding_; }
+
+ private:
+  String::Encoding encoding_;
+};
+
+
+class HTailCallThroughMegamorphicCacheShim : public HValueShim {
+ public:
+  DECLARE_SHIM(TailCallThroughMegamorphicCache)
+
+  explicit HTailCallThroughMegamorphicCacheShim(
+      HTailCallThroughMegamorphicCache* h)
+      : HValueShim(h),
+        flags_(h->flags()) {}
+
+  HTailCallThroughMegamorphicCacheShim(HValueShim base, Code::Flags flags)
+      : HValueShim(base),
+        flags_(flags) {}
+
+  Code::Flags flags() const { return flags_; }
+
+ private:
+  Code::Flags flags_;
+};
+
 } }  // namespace v8::internal
 
 #endif  // V8_HYDROGEN_SHIM_H_
@@ -40,6 +40,7 @@
 #include "src/lithium-allocator.h"
 #include "src/parser.h"
 #include "src/runtime/runtime.h"
+#include "src/saved-deopt-profile.h"
 #include "src/scopeinfo.h"
 #include "src/typing.h"
 
@@ -1251,6 +1252,38 @@ HBasicBlock* HGraphBuilder::CreateLoopHeaderBlock() {
 }
 
 
+bool HGraphBuilder::LoadedCodeSoftDeoptimizedHere() {
+  SavedDeoptProfile* deopt_profile = Compiler::saved_deopt_profile();
+  if (!deopt_profile || !Compiler::IsSavingCode() ||
+      !top_info()->IsOptimizing() ||
+      !top_info()->shared_info()->script()->IsScript()) {
+    return false;
+  }
+  // The deoptimizer reports the bailout id of the last simulate.
+  BailoutId ast_id = current_block()->last_environment()->ast_id();
+  for (HInstruction* instr = current_block()->last(); instr != NULL;
+       instr = instr->previous()) {
+    if (instr->IsSimulate()) {
+      ast_id = HSimulate::cast(instr)->ast_id();
+      break;
+    }
+  }
+  // Bailout ids are only unique within the function they belong to, which
+  // may be inlined.
+  SharedFunctionInfo* inner =
+      current_block()->last_environment()->closure()->shared();
+  if (!deopt_profile->DeoptimizedAt(*top_info()->shared_info(), inner,
+                                    ast_id, Deoptimizer::SOFT)) {
+    return false;
+  }
+  if (FLAG_trace_saveload) {
+    PrintF("[loaded code for %d soft deoptimized at %d, going generic]\n",
+           top_info()->shared_info()->start_position(), ast_id.ToInt());
+  }
+  return true;
+}
+
+
 HValue* HGraphBuilder::BuildGetElementsKind(HValue* object) {
   HValue* map = Add<HLoadNamedField>(object, static_cast<HValue*>(NULL),
                                      HObjectAccess::ForMap());
@@ -5782,7 +5815,7 @@ void HOptimizedGraphBuilder::VisitArrayLiteral(ArrayLiteral* expr) {
     NoObservableSideEffectsScope no_effects(this);
 
     Handle<FixedArray> constants;
-    if (!FLAG_save_code) {
+    if (!Compiler::IsSavingCode()) {
       // Boilerplate already exists and constant elements are never accessed,
       // pass an empty fixed array to the runtime function instead.
       constants = isolate()->factory()->empty_fixed_array();
@@ -6914,7 +6947,7 @@ HInstruction* HOptimizedGraphBuilder::BuildNamedGeneric(
     Handle<String> name,
     HValue* value,
     bool is_uninitialized) {
-  if (is_uninitialized) {
+  if (is_uninitialized && !LoadedCodeSoftDeoptimizedHere()) {
     Add<HDeoptimize>("Insufficient type feedback for generic named access",
                      Deoptimizer::SOFT);
   }
@@ -7304,12 +7337,14 @@ HValue* HOptimizedGraphBuilder::HandleKeyedElementAccess(
   } else {
     if (access_type == STORE) {
       if (expr->IsAssignment() &&
-          expr->AsAssignment()->HasNoTypeInformation()) {
+          expr->AsAssignment()->HasNoTypeInformation() &&
+          !LoadedCodeSoftDeoptimizedHere()) {
         Add<HDeoptimize>("Insufficient type feedback for keyed store",
                          Deoptimizer::SOFT);
       }
     } else {
-      if (expr->AsProperty()->HasNoTypeInformation()) {
+      if (expr->AsProperty()->HasNoTypeInformation() &&
+          !LoadedCodeSoftDeoptimizedHere()) {
         Add<HDeoptimize>("Insufficient type feedback for keyed load",
                          Deoptimizer::SOFT);
       }
@@ -10471,8 +10506,10 @@ HValue* HGraphBuilder::BuildBinaryOperation(
                            right_type->Maybe(Type::Receiver()));
 
   if (!left_type->IsInhabited()) {
-    Add<HDeoptimize>("Insufficient type feedback for LHS of binary operation",
-                     Deoptimizer::SOFT);
+    if (!LoadedCodeSoftDeoptimizedHere()) {
+      Add<HDeoptimize>("Insufficient type feedback for LHS of binary "
+                       "operation", Deoptimizer::SOFT);
+    }
     // TODO(rossberg): we should be able to get rid of non-continuous
     // defaults.
     left_type = Type::Any(zone());
@@ -10482,8 +10519,10 @@ HValue* HGraphBuilder::BuildBinaryOperation(
   }
 
   if (!right_type->IsInhabited()) {
-    Add<HDeoptimize>("Insufficient type feedback for RHS of binary operation",
-                     Deoptimizer::SOFT);
+    if (!LoadedCodeSoftDeoptimizedHere()) {
+      Add<HDeoptimize>("Insufficient type feedback for RHS of binary "
+                       "operation", Deoptimizer::SOFT);
+    }
     right_type = Type::Any(zone());
   } else {
     if (!maybe_string_add) right = TruncateToNumber(right, &right_type);
@@ -10978,9 +11017,11 @@ HControlInstruction* HOptimizedGraphBuilder::BuildCompareInstruction(
   // Cases handled below depend on collected type feedback. They should
   // soft deoptimize when there is no type feedback.
   if (!combined_type->IsInhabited()) {
-    Add<HDeoptimize>("Insufficient type feedback for combined type "
-                     "of binary operation",
-                     Deoptimizer::SOFT);
+    if (!LoadedCodeSoftDeoptimizedHere()) {
+      Add<HDeoptimize>("Insufficient type feedback for combined type "
+                       "of binary operation",
+                       Deoptimizer::SOFT);
+    }
     combined_type = left_type = right_type = Type::Any(zone());
   }
 
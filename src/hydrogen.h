@@ -1084,6 +1084,11 @@ class HGraphBuilder {
   void FinishCurrentBlock(HControlInstruction* last);
   void FinishExitCurrentBlock(HControlInstruction* instruction);
 
+  // Whether code loaded for the function being compiled was soft
+  // deoptimized at the current position, see --saveload-deopt-profile.
+  // Saved code then takes the generic path that follows instead.
+  bool LoadedCodeSoftDeoptimizedHere();
+
   void Goto(HBasicBlock* from,
             HBasicBlock* target,
             FunctionState* state = NULL,
@@ -310,6 +310,9 @@ class IC {
 
   FeedbackNexus* nexus_;
 
+  // Patches recorded IC states into freshly generated full code.
+  friend class SavedTypeFeedback;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(IC);
 };
 
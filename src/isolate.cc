@@ -15,9 +15,11 @@
 #include "src/base/utils/random-number-generator.h"
 #include "src/basic-block-profiler.h"
 #include "src/bootstrapper.h"
+#include "src/code-block-database.h"
 #include "src/codegen.h"
 #include "src/compilation-cache.h"
 #include "src/compilation-statistics.h"
+#include "src/compiler.h"
 #include "src/cpu-profiler.h"
 #include "src/debug.h"
 #include "src/deoptimizer.h"
@@ -26,13 +28,16 @@
 #include "src/hydrogen.h"
 #include "src/ic/stub-cache.h"
 #include "src/isolate-inl.h"
+#include "src/jsfunction-registry.h"
 #include "src/lithium-allocator.h"
 #include "src/log.h"
 #include "src/messages.h"
 #include "src/prototype.h"
 #include "src/regexp-stack.h"
 #include "src/runtime-profiler.h"
+#include "src/saved-map-cache.h"
 #include "src/sampler.h"
+#include "src/saved-type-feedback.h"
 #include "src/scopeinfo.h"
 #include "src/serialize.h"
 #include "src/simulator.h"
@@ -1649,7 +1654,10 @@ Isolate::Isolate(bool enable_serializer)
       next_unique_sfi_id_(0),
 #endif
       use_counter_callback_(NULL),
-      basic_block_profiler_(NULL) {
+      basic_block_profiler_(NULL),
+      jsfunction_registry_(NULL),
+      saved_constants_(NULL),
+      saved_map_cache_(NULL) {
   {
     base::LockGuard<base::Mutex> lock_guard(thread_data_table_mutex_.Pointer());
     CHECK(thread_data_table_);
@@ -1753,6 +1761,10 @@ void Isolate::Deinit() {
     PrintF(stdout, "=== Stress deopt counter: %u\n", stress_deopt_count_);
   }
 
+  if (FLAG_saveload_record_feedback) {
+    Compiler::saved_type_feedback()->Record(this);
+  }
+
   // We must stop the logger before we tear down other components.
   Sampler* sampler = logger_->sampler();
   if (sampler && sampler->IsActive()) sampler->Stop();
@@ -1770,6 +1782,17 @@ void Isolate::Deinit() {
   delete basic_block_profiler_;
   basic_block_profiler_ = NULL;
 
+  delete jsfunction_registry_;
+  jsfunction_registry_ = NULL;
+
+  if (saved_constants_ != NULL) {
+    GlobalHandles::Destroy(saved_constants_);
+    saved_constants_ = NULL;
+  }
+
+  delete saved_map_cache_;
+  saved_map_cache_ = NULL;
+
   heap_.TearDown();
   logger_->TearDown();
 
@@ -2507,36 +2530,74 @@ BasicBlockProfiler* Isolate::GetOrCreateBasicBlockProfiler() {
 }
 
 
-template<typename T>
-void Isolate::AddForStartPosition(List<ByStartPosition<T>>& list,
-                                  int start_position,
-                                  Handle<T> value) {
-  for (auto& rec: list) {
-    if (rec.start_position == start_position) {
-      rec.value = value;
-      return;
-    }
+void Isolate::AddJSFunctionForStartPosition(Handle<JSFunction> function) {
+  if (!Compiler::IsLoadingCode()) {
+    return;
+  }
+  // Closures in other contexts can't be found by start position, and only
+  // normal scripts have their code saved.
+  Object* script = function->shared()->script();
+  if (!function->context()->IsNativeContext() || !script->IsScript() ||
+      Script::cast(script)->type()->value() != Script::TYPE_NORMAL) {
+    return;
+  }
+  if (jsfunction_registry_ == NULL) {
+    jsfunction_registry_ = new JSFunctionRegistry(this);
   }
+  jsfunction_registry_->Add(function);
+}
 
-  list.Add(ByStartPosition<T>{ start_position, value });
+
+Handle<JSFunction> Isolate::GetJSFunctionByStartPosition(int source_hash,
+                                                         int start_position) {
+  if (jsfunction_registry_ == NULL) {
+    return Handle<JSFunction>::null();
+  }
+  return jsfunction_registry_->Lookup(source_hash, start_position);
 }
 
 
-template<typename T>
-Handle<T> Isolate::GetByStartPosition(List<ByStartPosition<T>>& list,
-                                      int start_position) {
-  for (auto& rec: list) {
-    if (rec.start_position == start_position) {
-      return rec.value;
-    }
+Handle<FixedArray> Isolate::GetJSFunctionsWithStartPositions() {
+  if (jsfunction_registry_ == NULL) {
+    return factory()->empty_fixed_array();
+  }
+  return jsfunction_registry_->GetFunctions();
+}
+
+
+SavedMapCache* Isolate::saved_map_cache() {
+  if (saved_map_cache_ == NULL) {
+    saved_map_cache_ = new SavedMapCache(this);
   }
-  return Handle<T>::null();
+  return saved_map_cache_;
 }
 
 
-// Instantiate.
-template void Isolate::AddForStartPosition<JSFunction>(List<ByStartPosition<JSFunction>>&, int, Handle<JSFunction>);
-template Handle<JSFunction> Isolate::GetByStartPosition(List<ByStartPosition<JSFunction>>&, int);
+Handle<FixedArray> Isolate::GetSavedConstants(const SavedConstantPool* pool) {
+  if (saved_constants_ == NULL) {
+    saved_constants_ = global_handles()->Create(
+        *factory()->NewFixedArray(pool->id() + 1, TENURED)).location();
+  }
+  Handle<FixedArray> pools(FixedArray::cast(*saved_constants_));
+  if (pools->length() <= pool->id()) {
+    pools = FixedArray::CopySize(pools, pool->id() + 1, TENURED);
+    *saved_constants_ = *pools;
+  }
+
+  // The pool may have grown since, if code is being saved to it.
+  Object* constants = pools->get(pool->id());
+  if (constants->IsFixedArray() &&
+      FixedArray::cast(constants)->length() >= pool->length()) {
+    return handle(FixedArray::cast(constants), this);
+  }
+  Handle<FixedArray> new_constants =
+      constants->IsFixedArray()
+          ? FixedArray::CopySize(handle(FixedArray::cast(constants), this),
+                                 pool->length(), TENURED)
+          : factory()->NewFixedArray(pool->length(), TENURED);
+  pools->set(pool->id(), *new_constants);
+  return new_constants;
+}
 
 
 std::string Isolate::GetTurboCfgFileName() {
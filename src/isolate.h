@@ -58,6 +58,9 @@ class HStatistics;
 class HTracer;
 class InlineRuntimeFunctionsTable;
 class InnerPointerToCodeCache;
+class JSFunctionRegistry;
+class SavedConstantPool;
+class SavedMapCache;
 class MaterializedObjectStore;
 class CodeAgingHelper;
 class RegExpStack;
@@ -1104,14 +1107,18 @@ class Isolate {
   BasicBlockProfiler* GetOrCreateBasicBlockProfiler();
   BasicBlockProfiler* basic_block_profiler() { return basic_block_profiler_; }
 
-  void AddJSFunctionForStartPosition(int start_position,
-                                     Handle<JSFunction> function) {
-    DCHECK(function->context()->IsNativeContext());
-    AddForStartPosition(jsfunctions_by_start_position_, start_position, function);
-  }
-  Handle<JSFunction> GetJSFunctionByStartPosition(int start_position) {
-    return GetByStartPosition(jsfunctions_by_start_position_, start_position);
-  }
+  // Registry of top-level closures, only maintained when loading code.
+  void AddJSFunctionForStartPosition(Handle<JSFunction> function);
+  Handle<JSFunction> GetJSFunctionByStartPosition(int source_hash,
+                                                  int start_position);
+  Handle<FixedArray> GetJSFunctionsWithStartPositions();
+
+  // The constants of |pool| that have been materialized in this isolate, by
+  // index.  The others are undefined.
+  Handle<FixedArray> GetSavedConstants(const SavedConstantPool* pool);
+
+  // Maps loaded from saved code, only maintained when loading code.
+  SavedMapCache* saved_map_cache();
 
   static Isolate* NewForTesting() { return new Isolate(false); }
 
@@ -1333,18 +1340,12 @@ class Isolate {
   v8::Isolate::UseCounterCallback use_counter_callback_;
   BasicBlockProfiler* basic_block_profiler_;
 
-  template<typename T>
-  struct ByStartPosition {
-    int start_position;
-    Handle<T> value;
-  };
+  JSFunctionRegistry* jsfunction_registry_;
 
-  template<typename T>
-  void AddForStartPosition(List<ByStartPosition<T>>&, int, Handle<T>);
-  template<typename T>
-  Handle<T> GetByStartPosition(List<ByStartPosition<T>>&, int);
+  // Global handle to the arrays returned by GetSavedConstants, by pool id.
+  Object** saved_constants_;
 
-  List<ByStartPosition<JSFunction>> jsfunctions_by_start_position_;
+  SavedMapCache* saved_map_cache_;
 
   friend class ExecutionAccess;
   friend class HandleScopeImplementer;
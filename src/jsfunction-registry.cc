@@ -0,0 +1,92 @@
+#include "src/jsfunction-registry.h"
+
+#include "src/factory.h"
+#include "src/global-handles.h"
+#include "src/isolate.h"
+
+namespace v8 {
+namespace internal {
+
+void JSFunctionRegistry::Add(Handle<JSFunction> function) {
+  Script* script = Script::cast(function->shared()->script());
+  Node key = { this, script->GetSourceHash(),
+               function->shared()->start_position(), NULL };
+  HashMap::Entry* entry = HashMap::Lookup(&key, key.Hash(), true);
+  Node* node = static_cast<Node*>(entry->value);
+  if (node != NULL) {
+    if (*node->location == *function) {
+      return;
+    }
+    // The old function can't be looked up any more, so there is no point
+    // in waiting for it to die.
+    GlobalHandles::Destroy(node->location);
+  } else {
+    node = new Node(key);
+    entry->key = node;
+    entry->value = node;
+  }
+
+  // Globalize the function, make it weak and use the location of the
+  // global handle as the value in the hash map.
+  node->location = isolate_->global_handles()->Create(*function).location();
+  GlobalHandles::MakeWeak(node->location,
+                          node,
+                          JSFunctionRegistry::HandleWeakFunction);
+}
+
+
+Handle<JSFunction> JSFunctionRegistry::Lookup(int source_hash,
+                                              int start_position) {
+  Node key = { this, source_hash, start_position, NULL };
+  HashMap::Entry* entry = HashMap::Lookup(&key, key.Hash(), false);
+  if (entry == NULL) {
+    return Handle<JSFunction>::null();
+  }
+  Node* node = static_cast<Node*>(entry->value);
+  return Handle<JSFunction>(JSFunction::cast(*node->location), isolate_);
+}
+
+
+Handle<FixedArray> JSFunctionRegistry::GetFunctions() {
+  Handle<FixedArray> functions =
+      isolate_->factory()->NewFixedArray(occupancy());
+  int count = 0;
+  for (HashMap::Entry* entry = Start(); entry != NULL; entry = Next(entry)) {
+    Node* node = static_cast<Node*>(entry->value);
+    functions->set(count++, *node->location);
+  }
+  // Allocating the array may have collected some of the functions.
+  if (count < functions->length()) {
+    functions->Shrink(count);
+  }
+  return functions;
+}
+
+
+void JSFunctionRegistry::Clear() {
+  for (HashMap::Entry* entry = Start(); entry != NULL; entry = Next(entry)) {
+    Node* node = static_cast<Node*>(entry->value);
+    DCHECK((*node->location)->IsJSFunction());
+    GlobalHandles::ClearWeakness(node->location);
+    GlobalHandles::Destroy(node->location);
+    delete node;
+  }
+  HashMap::Clear();
+}
+
+
+void JSFunctionRegistry::HandleWeakFunction(
+    const v8::WeakCallbackData<v8::Value, void>& data) {
+  Node* node = static_cast<Node*>(data.GetParameter());
+
+  // Remove the corresponding entry from the registry and clear the weak
+  // handle.  Replaced functions have their handles destroyed right away, so
+  // the entry must be ours.
+  void* removed = node->registry->Remove(node, node->Hash());
+  DCHECK(removed == node);
+  USE(removed);
+  GlobalHandles::Destroy(node->location);
+  delete node;
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,68 @@
+#ifndef V8_JSFUNCTION_REGISTRY_H_
+#define V8_JSFUNCTION_REGISTRY_H_
+
+#include "src/handles.h"
+#include "src/hashmap.h"
+
+namespace v8 {
+namespace internal {
+
+// Top-level closures of the isolate, keyed by the source hash of their
+// script and the start position of their function literal.  Used to resolve
+// kByStartPosition relocations when loading saved code.  The functions are
+// held through weak global handles, so the registry does not keep them
+// alive: an entry is dropped as soon as its function is collected.
+class JSFunctionRegistry : private HashMap {
+ public:
+  explicit JSFunctionRegistry(Isolate* isolate)
+      : HashMap(Node::Match),
+        isolate_(isolate) {}
+  ~JSFunctionRegistry() { Clear(); }
+
+  // Replaces the function previously registered at the same position.
+  void Add(Handle<JSFunction> function);
+
+  // Returns a null handle if there is no live function at the position.
+  Handle<JSFunction> Lookup(int source_hash, int start_position);
+
+  // Return the functions in the registry.
+  Handle<FixedArray> GetFunctions();
+
+ private:
+  // Both the key and the value of a hash map entry.  Also passed to the weak
+  // handle callback.
+  struct Node {
+    JSFunctionRegistry* registry;
+    int source_hash;
+    int start_position;
+    Object** location;
+
+    uint32_t Hash() const {
+      return ComputeIntegerHash(static_cast<uint32_t>(source_hash) ^
+                                    static_cast<uint32_t>(start_position),
+                                v8::internal::kZeroHashSeed);
+    }
+
+    static bool Match(void* key1, void* key2) {
+      Node* node1 = static_cast<Node*>(key1);
+      Node* node2 = static_cast<Node*>(key2);
+      return node1->source_hash == node2->source_hash &&
+             node1->start_position == node2->start_position;
+    }
+  };
+
+  // Clear the registry releasing all the weak handles.
+  void Clear();
+
+  // Weak handle callback for functions in the registry.
+  static void HandleWeakFunction(
+      const v8::WeakCallbackData<v8::Value, void>& data);
+
+  Isolate* isolate_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSFunctionRegistry);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_JSFUNCTION_REGISTRY_H_
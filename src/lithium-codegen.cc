@@ -181,11 +181,13 @@ static void AddWeakObjectToCodeDependency(Isolate* isolate,
 }
 
 
-void LCodeGenBase::RegisterWeakObjectsInOptimizedCode(Handle<Code> code) {
+void LCodeGenBase::RegisterWeakObjectsInOptimizedCode(Handle<Code> code,
+                                                      Zone* zone) {
   DCHECK(code->is_optimized_code());
-  ZoneList<Handle<Map> > maps(1, zone());
-  ZoneList<Handle<JSObject> > objects(1, zone());
-  ZoneList<Handle<Cell> > cells(1, zone());
+  Isolate* isolate = code->GetIsolate();
+  ZoneList<Handle<Map> > maps(1, zone);
+  ZoneList<Handle<JSObject> > objects(1, zone);
+  ZoneList<Handle<Cell> > cells(1, zone);
   int mode_mask = RelocInfo::ModeMask(RelocInfo::EMBEDDED_OBJECT) |
                   RelocInfo::ModeMask(RelocInfo::CELL);
   for (RelocIterator it(*code, mode_mask); !it.done(); it.next()) {
@@ -193,18 +195,18 @@ void LCodeGenBase::RegisterWeakObjectsInOptimizedCode(Handle<Code> code) {
     if (mode == RelocInfo::CELL &&
         code->IsWeakObjectInOptimizedCode(it.rinfo()->target_cell())) {
       Handle<Cell> cell(it.rinfo()->target_cell());
-      cells.Add(cell, zone());
+      cells.Add(cell, zone);
     } else if (mode == RelocInfo::EMBEDDED_OBJECT &&
                code->IsWeakObjectInOptimizedCode(it.rinfo()->target_object())) {
       if (it.rinfo()->target_object()->IsMap()) {
         Handle<Map> map(Map::cast(it.rinfo()->target_object()));
-        maps.Add(map, zone());
+        maps.Add(map, zone);
       } else if (it.rinfo()->target_object()->IsJSObject()) {
         Handle<JSObject> object(JSObject::cast(it.rinfo()->target_object()));
-        objects.Add(object, zone());
+        objects.Add(object, zone);
       } else if (it.rinfo()->target_object()->IsCell()) {
         Handle<Cell> cell(Cell::cast(it.rinfo()->target_object()));
-        cells.Add(cell, zone());
+        cells.Add(cell, zone);
       }
     }
   }
@@ -222,10 +224,10 @@ void LCodeGenBase::RegisterWeakObjectsInOptimizedCode(Handle<Code> code) {
     Map::AddDependentCode(maps.at(i), DependentCode::kWeakCodeGroup, code);
   }
   for (int i = 0; i < objects.length(); i++) {
-    AddWeakObjectToCodeDependency(isolate(), objects.at(i), code);
+    AddWeakObjectToCodeDependency(isolate, objects.at(i), code);
   }
   for (int i = 0; i < cells.length(); i++) {
-    AddWeakObjectToCodeDependency(isolate(), cells.at(i), code);
+    AddWeakObjectToCodeDependency(isolate, cells.at(i), code);
   }
 }
 
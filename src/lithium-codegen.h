@@ -46,7 +46,12 @@ class LCodeGenBase BASE_EMBEDDED {
 
   int GetNextEmittedBlock() const;
 
-  void RegisterWeakObjectsInOptimizedCode(Handle<Code> code);
+  void RegisterWeakObjectsInOptimizedCode(Handle<Code> code) {
+    RegisterWeakObjectsInOptimizedCode(code, zone());
+  }
+  // Also used for optimized code that is loaded instead of generated.
+  static void RegisterWeakObjectsInOptimizedCode(Handle<Code> code,
+                                                 Zone* zone);
 
   // Check that an environment assigned via AssignEnvironment is actually being
   // used. Redundant assignments keep things alive longer than necessary, and
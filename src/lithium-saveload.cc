@@ -1,5 +1,8 @@
 #include "src/lithium-saveload.h"
 
+#include "src/saved-map-cache.h"
+#include "src/saveload-report.h"
+
 #if V8_TARGET_ARCH_X64
 #include "src/x64/lithium-x64.h"  // NOLINT
 #include "src/x64/lithium-saveload-x64.h"  // NOLINT
@@ -240,12 +243,76 @@ Handle<Oddball> LChunkLoaderBase::LoadOddball() {
 
 
 void LChunkSaverBase::SaveHeapNumber(HeapNumber* number) {
-  SavePrimitive<double>(number->value());
+  double value = number->value();
+  if (!constants_) {
+    SaveFalse();
+    SavePrimitive<double>(value);
+    return;
+  }
+  SaveTrue();
+  SaveConstant(SavedConstantPool::kHeapNumber,
+               Vector<const char>(reinterpret_cast<const char*>(&value),
+                                  sizeof(value)));
 }
 
 
 Handle<HeapNumber> LChunkLoaderBase::LoadHeapNumber() {
-  return isolate()->factory()->NewHeapNumber(LoadPrimitive<double>());
+  if (!LoadBool()) {
+    return isolate()->factory()->NewHeapNumber(LoadPrimitive<double>());
+  }
+  Handle<Object> number = LoadConstant(SavedConstantPool::kHeapNumber);
+  RETURN_VALUE_ON_FAIL(isolate()->factory()->NewHeapNumber(0));
+  return Handle<HeapNumber>::cast(number);
+}
+
+
+void LChunkSaverBase::SaveConstant(SavedConstantPool::Kind kind,
+                                   Vector<const char> data) {
+  DCHECK(constants_);
+  SavePrimitive<int>(constants_->Add(kind, data));
+}
+
+
+// Pooled constants are materialized once per isolate.  Strings are
+// internalized and heap numbers are immutable, so they can be shared by all
+// the code that refers to them.
+Handle<Object> LChunkLoaderBase::LoadConstant(SavedConstantPool::Kind kind) {
+  auto index = LoadPrimitive<int>();
+  if (!constants_ || index < 0 || index >= constants_->length() ||
+      constants_->GetKind(index) != kind) {
+    Fail("invalid constant pool index");
+    return Handle<Object>::null();
+  }
+
+  if (materialized_constants_.is_null()) {
+    materialized_constants_ = isolate()->GetSavedConstants(constants_);
+  }
+  Object* materialized = materialized_constants_->get(index);
+  if (!materialized->IsUndefined()) {
+    return handle(materialized, isolate());
+  }
+
+  Vector<const char> data = constants_->GetData(index);
+  Handle<Object> constant;
+  switch (kind) {
+    case SavedConstantPool::kInternalizedString:
+      constant = isolate()->factory()->InternalizeUtf8String(data);
+      break;
+
+    case SavedConstantPool::kHeapNumber: {
+      if (data.length() != sizeof(double)) {
+        Fail("invalid pooled heap number");
+        return Handle<Object>::null();
+      }
+      double value;
+      memcpy(&value, data.start(), sizeof(value));
+      constant = isolate()->factory()->NewHeapNumber(value, IMMUTABLE,
+                                                     TENURED);
+      break;
+    }
+  }
+  materialized_constants_->set(index, *constant);
+  return constant;
 }
 
 
@@ -350,22 +417,69 @@ Handle<Symbol> LChunkLoaderBase::LoadSymbol() {
 }
 
 
+// Strings are saved as a tag followed by either the data or an index into
+// the constant pool.
+enum StringTag {
+  kInlineString,
+  kInlineInternalizedString,
+  kPooledString  // Always internalized.
+};
+
+
 void LChunkSaverBase::SaveString(String* string, int offset, int length) {
+  bool internalized = string->IsInternalizedString();
+  // Only whole internalized strings can be looked up by their address.
+  bool whole = offset == 0 && (length < 0 || length == string->length());
+  if (constants_ && internalized && whole) {
+    HashMap::Entry* entry =
+        strings_.Lookup(string, ComputePointerHash(string), false);
+    if (entry) {
+      SavePrimitive<int>(kPooledString);
+      SavePrimitive<int>(static_cast<int>(
+          reinterpret_cast<intptr_t>(entry->value)));
+      return;
+    }
+  }
+
   int byte_length;
   SmartArrayPointer<char> str =
     string->ToCString(ALLOW_NULLS, FAST_STRING_TRAVERSAL,
                       offset, length, &byte_length);
-  SavePrimitiveArray(Vector<const char>(str.get(), byte_length));
+  Vector<const char> data(str.get(), byte_length);
+  if (constants_ && internalized) {
+    int index =
+        constants_->Add(SavedConstantPool::kInternalizedString, data);
+    if (whole) {
+      strings_.Lookup(string, ComputePointerHash(string), true)->value =
+          reinterpret_cast<void*>(static_cast<intptr_t>(index));
+    }
+    SavePrimitive<int>(kPooledString);
+    SavePrimitive<int>(index);
+    return;
+  }
+  SaveStringData(data, internalized);
+}
 
-  SavePrimitive<bool>(string->IsInternalizedString());
+
+void LChunkSaverBase::SaveStringData(Vector<const char> data,
+                                     bool internalized) {
+  SavePrimitive<int>(internalized ? kInlineInternalizedString
+                                  : kInlineString);
+  SavePrimitiveArray(data);
 }
 
 
 Handle<String> LChunkLoaderBase::LoadString() {
-  Vector<const char> str = LoadPrimitiveArray<const char>();
+  auto tag = LoadPrimitive<int>();
+  if (tag == kPooledString) {
+    Handle<Object> string =
+        LoadConstant(SavedConstantPool::kInternalizedString);
+    RETURN_VALUE_ON_FAIL(isolate()->factory()->empty_string());
+    return Handle<String>::cast(string);
+  }
 
-  bool internalize = LoadBool();
-  return internalize
+  Vector<const char> str = LoadPrimitiveArray<const char>();
+  return tag == kInlineInternalizedString
     ? isolate()->factory()->InternalizeUtf8String(str)
     : isolate()->factory()->NewStringFromUtf8(str).ToHandleChecked();
 }
@@ -379,24 +493,22 @@ void LChunkSaverBase::SaveJSRegExp(JSRegExp* regexp) {
   // The rest of this function saves `flags` as a String instance.
   // Couldn't find a reusable implementation of the conversion across V8.
 
-  SavePrimitive<size_t>(flags.is_global() + flags.is_ignore_case() +
-                        flags.is_multiline() + flags.is_sticky());
-
+  char flag_chars[4];
+  int length = 0;
   if (flags.is_global()) {
-    SavePrimitive<char>('g');
+    flag_chars[length++] = 'g';
   }
   if (flags.is_ignore_case()) {
-    SavePrimitive<char>('i');
+    flag_chars[length++] = 'i';
   }
   if (flags.is_multiline()) {
-    SavePrimitive<char>('m');
+    flag_chars[length++] = 'm';
   }
   if (flags.is_sticky()) {
-    SavePrimitive<char>('y');
+    flag_chars[length++] = 'y';
   }
 
-  // Not internalized.
-  SaveFalse();
+  SaveStringData(Vector<const char>(flag_chars, length), false);
 }
 
 
@@ -450,11 +562,26 @@ void LChunkSaverBase::SaveFixedArray(FixedArray* array) {
 Handle<FixedArray> LChunkLoaderBase::LoadFixedArray() {
   auto length = LoadPrimitive<int>();
   Handle<FixedArray> array = isolate()->factory()->NewFixedArray(length);
-  LoadFixedArrayData(*array);
+  LoadFixedArrayData(array);
   return array;
 }
 
 
+// Scope infos are fixed arrays too, but have a map of their own.
+void LChunkSaverBase::SaveScopeInfo(ScopeInfo* scope_info) {
+  SavePrimitive<int>(scope_info->length());
+  SaveFixedArrayData(scope_info);
+}
+
+
+Handle<ScopeInfo> LChunkLoaderBase::LoadScopeInfo() {
+  auto length = LoadPrimitive<int>();
+  Handle<ScopeInfo> scope_info = isolate()->factory()->NewScopeInfo(length);
+  LoadFixedArrayData(scope_info);
+  return scope_info;
+}
+
+
 void LChunkSaverBase::SaveFixedArrayData(FixedArray* array) {
   for (int i = 0; i < array->length(); ++i) {
     Object* item = array->get(i);
@@ -464,7 +591,8 @@ void LChunkSaverBase::SaveFixedArrayData(FixedArray* array) {
 }
 
 
-void LChunkLoaderBase::LoadFixedArrayData(FixedArray* array) {
+// Loading an item may allocate, so |array| is only dereferenced after it.
+void LChunkLoaderBase::LoadFixedArrayData(Handle<FixedArray> array) {
   for (int i = 0; i < array->length(); ++i) {
     Handle<Object> item = LoadObject();
     RETURN_ON_FAIL();
@@ -594,10 +722,76 @@ enum FunctionRelocationType {
   kByStartPosition,
   kByOriginalName,
   kByGlobalConstructor,
-  kByGlobalPrototype
+  kByGlobalPrototype,
+  kByContextSlot
+};
+
+
+// Where an inner function can be found from the context of the function
+// being compiled: |depth| contexts up the chain, in slot |index| of that
+// context, either directly or as the own property |name| of the object in
+// that slot.  Module patterns keep their functions in such slots.
+struct ContextSlotPath {
+  int depth;
+  int index;
+  Name* name;  // NULL if the slot holds the function itself.
 };
 
 
+static Name* FindOwnFastProperty(JSObject* holder, JSFunction* function) {
+  if (!holder->HasFastProperties()) {
+    return NULL;
+  }
+  Map* map = holder->map();
+  DescriptorArray* descriptors = map->instance_descriptors();
+  for (int i = 0; i < map->NumberOfOwnDescriptors(); ++i) {
+    PropertyDetails details = descriptors->GetDetails(i);
+    Object* value;
+    if (details.type() == CONSTANT) {
+      value = descriptors->GetValue(i);
+    } else if (details.type() == FIELD) {
+      value = holder->RawFastPropertyAt(FieldIndex::ForDescriptor(map, i));
+    } else {
+      continue;
+    }
+    if (value == function) {
+      return descriptors->GetKey(i);
+    }
+  }
+  return NULL;
+}
+
+
+static bool FindInContextChain(Context* context, JSFunction* function,
+                               ContextSlotPath* path) {
+  for (int depth = 0; !context->IsNativeContext();
+       context = context->previous(), ++depth) {
+    for (int index = Context::MIN_CONTEXT_SLOTS; index < context->length();
+         ++index) {
+      Object* slot = context->get(index);
+      if (slot == function) {
+        *path = { depth, index, NULL };
+        return true;
+      }
+    }
+    // A second pass, so that a direct reference is preferred.
+    for (int index = Context::MIN_CONTEXT_SLOTS; index < context->length();
+         ++index) {
+      Object* slot = context->get(index);
+      if (!slot->IsJSObject() || slot->IsJSFunction()) {
+        continue;
+      }
+      Name* name = FindOwnFastProperty(JSObject::cast(slot), function);
+      if (name != NULL) {
+        *path = { depth, index, name };
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+
 // Not all BuiltinFunctionIds are of value for us.  This function checks if
 // BuiltinFunctionId is "indexed", that is it has enough associated
 // information about the function is encodes to uniquely identify that
@@ -753,13 +947,30 @@ void LChunkSaverBase::SaveJSFunction(JSFunction* function) {
   if (!function->shared()->native() && !function->IsBuiltin()) {
     if (!function->context()->IsNativeContext()) {
       // Inner functions are impossible to recover by start position
-      // since there may be many instances for the same position.
+      // since there may be many instances for the same position, but the
+      // instance reachable from our own context is the one we want.
+      ContextSlotPath path;
+      if (!FindInContextChain(info()->closure()->context(), function,
+                              &path)) {
+        Fail("refs to inner JSFs");
+        return;
+      }
 
-      Fail("refs to inner JSFs");
+      SavePrimitive<FunctionRelocationType>(kByContextSlot);
+      SavePrimitive<int>(path.depth);
+      SavePrimitive<int>(path.index);
+      SavePrimitive<bool>(path.name != NULL);
+      if (path.name != NULL) {
+        SaveName(path.name);
+      }
+      // Checked on load, as the slot may have been reassigned since.
+      SavePrimitive<int>(function->shared()->start_position());
       return;
     }
 
+    Script* script = Script::cast(function->shared()->script());
     SavePrimitive<FunctionRelocationType>(kByStartPosition);
+    SavePrimitive<int>(script->GetSourceHash());
     SavePrimitive<int>(function->shared()->start_position());
     return;
   }
@@ -877,6 +1088,7 @@ Handle<JSFunction> LChunkLoaderBase::LoadJSFunction() {
 
   switch (relocation) {
     case kByNameInContextChain: {
+      context_dependent_loads_++;
       Handle<String> name = LoadString();
 
       int slot_index;
@@ -903,9 +1115,10 @@ Handle<JSFunction> LChunkLoaderBase::LoadJSFunction() {
     }
 
     case kByStartPosition: {
+      auto source_hash = LoadPrimitive<int>();
       auto start_position = LoadPrimitive<int>();
       Handle<JSFunction> function =
-          isolate()->GetJSFunctionByStartPosition(start_position);
+          isolate()->GetJSFunctionByStartPosition(source_hash, start_position);
       if (function.is_null()) {
         Fail("function not found by start position");
       }
@@ -945,6 +1158,41 @@ Handle<JSFunction> LChunkLoaderBase::LoadJSFunction() {
           descriptors->GetValue(descriptor_index)));
     }
 
+    case kByContextSlot: {
+      context_dependent_loads_++;
+      auto depth = LoadPrimitive<int>();
+      auto index = LoadPrimitive<int>();
+      Handle<Name> name;
+      if (LoadPrimitive<bool>()) {
+        name = LoadName();
+      }
+      auto start_position = LoadPrimitive<int>();
+
+      Context* context = info()->closure()->context();
+      for (int i = 0; i < depth && !context->IsNativeContext(); ++i) {
+        context = context->previous();
+      }
+      if (context->IsNativeContext() || index >= context->length()) {
+        Fail("context chain does not match");
+        return Handle<JSFunction>::null();
+      }
+
+      Handle<Object> object(context->get(index), isolate());
+      if (!name.is_null() && object->IsJSObject()) {
+        object = JSObject::GetDataProperty(Handle<JSObject>::cast(object),
+                                           name);
+      } else if (!name.is_null()) {
+        object = isolate()->factory()->undefined_value();
+      }
+      if (!object->IsJSFunction() ||
+          JSFunction::cast(*object)->shared()->start_position() !=
+              start_position) {
+        Fail("function not found in context slot");
+        return Handle<JSFunction>::null();
+      }
+      return Handle<JSFunction>::cast(object);
+    }
+
     case kByOriginalName: {
       Handle<String> name = LoadString();
       Handle<GlobalObject> builtins(isolate()->js_builtins_object());
@@ -964,6 +1212,18 @@ Handle<JSFunction> LChunkLoaderBase::LoadJSFunction() {
 }
 
 
+// How a map in a saved chain is derived from its parent.
+enum MapTransitionType {
+  kCopyDropDescriptors,
+  kSpecialTransition,
+  kPropertyTransition,
+  // The transition from the parent was overwritten, e.g. by a field
+  // generalization, so the map is recreated from its descriptors without
+  // connecting it to the parent.
+  kDetachedCopy
+};
+
+
 class LChunkSaverBase::MapSaver {
  public:
   MapSaver(LChunkSaverBase* saver)
@@ -972,18 +1232,36 @@ class LChunkSaverBase::MapSaver {
   Isolate* isolate() { return saver_->isolate(); }
 
   void SaveMap(Map* map) {
+    // Maps already saved in this record, including the ones that are still
+    // being saved, are referred to by index.
+    int saved_map_index = SavedMapIndex(map);
+    if (saved_map_index >= 0) {
+      saver_->SaveTrue();
+      saver_->SavePrimitive<int>(saved_map_index);
+      return;
+    }
+    saver_->SaveFalse();
+
     if (!CreateMapChain(map)) {
       DCHECK(saver_->LastStatus() == LChunkSaverBase::FAILED);
       return;
     }
 
-    // Save root map.
+    // Save root map, which is either a map saved earlier in this record or
+    // the root of the transition tree.
     Map* root_map = chain_.last();
-    auto root_index = GetStableRootIndex(root_map);
-    saver_->SavePrimitive<Heap::RootListIndex>(root_index);
-    if (root_index == Heap::kNotFound) {
-      EnterMap(root_map);
-      ExitMap(root_map);
+    int root_saved_map_index = SavedMapIndex(root_map);
+    if (root_saved_map_index >= 0) {
+      saver_->SaveTrue();
+      saver_->SavePrimitive<int>(root_saved_map_index);
+    } else {
+      saver_->SaveFalse();
+      auto root_index = GetStableRootIndex(root_map);
+      saver_->SavePrimitive<Heap::RootListIndex>(root_index);
+      if (root_index == Heap::kNotFound) {
+        EnterMap(root_map);
+        ExitMap(root_map);
+      }
     }
 
     // #transitions = #maps - 1
@@ -1000,59 +1278,73 @@ class LChunkSaverBase::MapSaver {
 
       if (!map->NumberOfOwnDescriptors()) {
         // Just copy the thing.
-        saver_->SaveTrue();
+        saver_->SavePrimitive<MapTransitionType>(kCopyDropDescriptors);
         ExitMap(map);
         continue;
       }
-      saver_->SaveFalse();
 
       DescriptorArray* descriptors = map->instance_descriptors();
-      Name* key;
+      Name* key = NULL;
 
       if (parent->NumberOfOwnDescriptors() + 1 ==
           map->NumberOfOwnDescriptors()) {
         key = descriptors->GetKey(parent->NumberOfOwnDescriptors());
       } else {
         int transition_index = parent->SearchTransitionForTarget(handle(map));
-        if (transition_index == TransitionArray::kNotFound) {
-          // Transition to child map was overwritten, but we currently
-          // have no idea how to recover it.
-          UNIMPLEMENTED();
+        if (transition_index != TransitionArray::kNotFound) {
+          key = parent->transitions()->GetKey(transition_index);
         }
-        key = parent->transitions()->GetKey(transition_index);
       }
 
-      if (TransitionArray::IsSpecialTransition(key)) {
-        saver_->SaveTrue();
+      if (key != NULL && TransitionArray::IsSpecialTransition(key)) {
+        saver_->SavePrimitive<MapTransitionType>(kSpecialTransition);
         saver_->SaveName(key);
         ExitMap(map);
         continue;
       }
-      saver_->SaveFalse();
 
-      int descriptor_index =
-        descriptors->Search(key, map->NumberOfOwnDescriptors());
+      int descriptor_index = key != NULL
+          ? descriptors->Search(key, map->NumberOfOwnDescriptors())
+          : DescriptorArray::kNotFound;
+      if (descriptor_index == DescriptorArray::kNotFound ||
+          descriptor_index < parent->NumberOfOwnDescriptors()) {
+        // The descriptors saved on entering the map are all we need.
+        saver_->SavePrimitive<MapTransitionType>(kDetachedCopy);
+        ExitMap(map);
+        continue;
+      }
 
-      DCHECK(descriptor_index != DescriptorArray::kNotFound &&
-             parent->NumberOfOwnDescriptors() <= descriptor_index &&
-             descriptor_index < map->NumberOfOwnDescriptors());
+      saver_->SavePrimitive<MapTransitionType>(kPropertyTransition);
       saver_->SavePrimitive<int>(descriptor_index);
       ExitMap(map);
     }
   }
 
  private:
+  int SavedMapIndex(Map* map) {
+    for (int i = 0; i < saver_->saved_maps_.length(); ++i) {
+      if (saver_->saved_maps_[i] == map) return i;
+    }
+    return -1;
+  }
+
+  // Collects the maps from |map| up to the root of its transition tree, or
+  // up to a map already saved in this record.
   bool CreateMapChain(Map* map) {
     for (Object* next = map; next->IsMap(); next = map->GetBackPointer()) {
       map = Map::cast(next);
       chain_.Add(map);
 
-      // Saving cyclic map chains is possible but results in too much of
-      // an overhead for the normal case.
+      // An ancestor that is still being saved can't be transitioned from
+      // on load, as its descriptors are not there yet.
       if (saver_->map_cache_.Contains(map)) {
         saver_->Fail("cyclic map chains");
         return false;
       }
+
+      if (saver_->saved_maps_.Contains(map)) {
+        break;
+      }
     }
 
     return true;
@@ -1077,6 +1369,7 @@ class LChunkSaverBase::MapSaver {
   void EnterMap(Map* map) {
     // Push this map to the stack, so that we can detect cycles between maps.
     saver_->map_cache_.Add(map);
+    saver_->saved_maps_.Add(map);
 
     SavePropertiesOnEnter(map);
   }
@@ -1158,8 +1451,30 @@ class LChunkSaverBase::MapSaver {
 };
 
 
+// A top-level map is saved as its hash and length followed by the MapSaver
+// record, so that the loader can look the record up in the isolate's
+// SavedMapCache before replaying it.  Maps saved while saving another map
+// (e.g. the maps of prototypes) are part of the enclosing record, which
+// they can refer back to.
 void LChunkSaverBase::SaveMap(Map* map) {
-  MapSaver(this).SaveMap(map);
+  if (!map_cache_.is_empty()) {
+    RETURN_ON_FAIL(MapSaver(this).SaveMap(map));
+    Synchronize();
+    return;
+  }
+
+  saved_maps_.Clear();
+  internal::SavePrimitive<uint32_t>(bytes_, 0);
+  internal::SavePrimitive<uint32_t>(bytes_, 0);
+  int start = bytes_.length();
+  RETURN_ON_FAIL(MapSaver(this).SaveMap(map));
+
+  uint32_t length = bytes_.length() - start;
+  uint32_t hash = SavedMapCache::Hash(
+      Vector<const char>(&bytes_[start], length));
+  char* prefix = &bytes_[start - 2 * sizeof(uint32_t)];
+  memcpy(prefix, &hash, sizeof(hash));
+  memcpy(prefix + sizeof(hash), &length, sizeof(length));
   Synchronize();
 }
 
@@ -1168,7 +1483,8 @@ class LChunkLoaderBase::MapLoader {
  public:
   MapLoader(LChunkLoaderBase* loader)
       : loader_(loader),
-        has_branched_(false) {}
+        has_branched_(false),
+        has_detached_copy_(false) {}
 
   Isolate* isolate() { return loader_->isolate(); }
   CompilationInfo* info() { return loader_->info(); }
@@ -1176,8 +1492,17 @@ class LChunkLoaderBase::MapLoader {
   MaybeHandle<Map> LoadMap() {
     Handle<Map> map;
 
-    auto root_index = loader_->LoadPrimitive<Heap::RootListIndex>();
-    if (root_index != Heap::kNotFound) {
+    if (loader_->LoadBool()) {
+      return GetLoadedMap();
+    }
+
+    bool is_loaded_root = loader_->LoadBool();
+    auto root_index = is_loaded_root
+        ? Heap::kNotFound
+        : loader_->LoadPrimitive<Heap::RootListIndex>();
+    if (is_loaded_root) {
+      if (!GetLoadedMap().ToHandle(&map)) return MaybeHandle<Map>();
+    } else if (root_index != Heap::kNotFound) {
       // Load first map from the roots.
       Object* root = isolate()->heap()->root(root_index);
       DCHECK(root->IsMap());
@@ -1188,6 +1513,7 @@ class LChunkLoaderBase::MapLoader {
       ElementsKind elements_kind = Map::ElementsKindBits::decode(bit_field2_);
       map = isolate()->factory()->
           NewMap(instance_type_, instance_size_, elements_kind);
+      loader_->loaded_maps_.Add(map);
       LoadPropertiesOnExit(map);
       if (loader_->LastStatus() != SUCCEEDED) return MaybeHandle<Map>();
       has_branched_ = true;
@@ -1201,20 +1527,25 @@ class LChunkLoaderBase::MapLoader {
 
       LoadPropertiesOnEnter();
 
-      bool copy_and_drop = loader_->LoadBool();
-      if (copy_and_drop) {
+      auto transition_type = loader_->LoadPrimitive<MapTransitionType>();
+      if (transition_type == kCopyDropDescriptors ||
+          transition_type == kDetachedCopy) {
         Handle<Map> child = Map::CopyDropDescriptors(map);
-        DCHECK(!map->is_prototype_map());
-        child->SetBackPointer(*map);
+        if (transition_type == kCopyDropDescriptors) {
+          DCHECK(!map->is_prototype_map());
+          child->SetBackPointer(*map);
+        } else {
+          has_detached_copy_ = true;
+        }
         map = child;
+        loader_->loaded_maps_.Add(map);
         LoadPropertiesOnExit(map);
         if (loader_->LastStatus() != SUCCEEDED) return MaybeHandle<Map>();
         has_branched_ = true;
         continue;
       }
 
-      bool is_special_transition = loader_->LoadBool();
-      if (is_special_transition) {
+      if (transition_type == kSpecialTransition) {
         Handle<Name> key = loader_->LoadName();
         DCHECK(TransitionArray::IsSpecialTransition(*key));
 
@@ -1229,6 +1560,7 @@ class LChunkLoaderBase::MapLoader {
           map = child;
           has_branched_ = true;
         }
+        loader_->loaded_maps_.Add(map);
         LoadPropertiesOnExit(map);
         if (loader_->LastStatus() != SUCCEEDED) return MaybeHandle<Map>();
         continue;
@@ -1243,6 +1575,7 @@ class LChunkLoaderBase::MapLoader {
                                         layout_descriptor, INSERT_TRANSITION,
                                         transition_key, "LoadMap",
                                         SIMPLE_PROPERTY_TRANSITION);
+      loader_->loaded_maps_.Add(map);
       LoadPropertiesOnExit(map);
       if (loader_->LastStatus() != SUCCEEDED) return MaybeHandle<Map>();
     }
@@ -1256,12 +1589,33 @@ class LChunkLoaderBase::MapLoader {
     Handle<Map> deduplicated;
     if (TryDeduplicate(map).ToHandle(&deduplicated)) {
       return deduplicated;
-    } else {
-      return map;
     }
+    if (has_detached_copy_) {
+      // The map is in no transition tree, so objects created by the
+      // optimized code won't share it with those created elsewhere.
+      if (FLAG_trace_saveload) {
+        PrintF("[detached map copy not deduplicated, function: ");
+        info()->shared_info()->ShortPrint();
+        PrintF(" at %d]\n", info()->shared_info()->start_position());
+      }
+      isolate()->counters()->saveload_detached_maps()->Increment();
+      if (Compiler::saveload_report() != nullptr) {
+        Compiler::saveload_report()->RecordDetachedMap(info());
+      }
+    }
+    return map;
   }
 
  private:
+  MaybeHandle<Map> GetLoadedMap() {
+    auto index = loader_->LoadPrimitive<int>();
+    if (index < 0 || index >= loader_->loaded_maps_.length()) {
+      loader_->Fail("bad map reference");
+      return MaybeHandle<Map>();
+    }
+    return loader_->loaded_maps_[index];
+  }
+
   void LoadPropertiesOnEnter() {
     loader_->Synchronize();
 
@@ -1397,12 +1751,51 @@ class LChunkLoaderBase::MapLoader {
   // Whether new root map or some intermediate maps were created
   // during the process of loading the map.
   bool has_branched_;
+  // Whether one of these maps was recreated as a detached copy.
+  bool has_detached_copy_;
 };
 
 
 Handle<Map> LChunkLoaderBase::LoadMap() {
-  Handle<Map> map;
-  if (MapLoader(this).LoadMap().ToHandle(&map)) {
+  if (loading_map_) {
+    Handle<Map> map;
+    if (MapLoader(this).LoadMap().ToHandle(&map)) {
+      Synchronize();
+      return map;
+    }
+    Fail("deduplication failed");
+    return Handle<Map>::null();
+  }
+
+  auto hash = internal::LoadPrimitive<uint32_t>(&bytes_);
+  auto length = internal::LoadPrimitive<uint32_t>(&bytes_);
+  if (length > static_cast<uint32_t>(storage_.end() - bytes_)) {
+    Fail("map record out of bounds");
+    return Handle<Map>::null();
+  }
+  Vector<const char> saved_map(bytes_, length);
+  int pool_id = constants_ ? constants_->id() : -1;
+  SavedMapCache* cache = isolate()->saved_map_cache();
+
+  Handle<Map> map = cache->Lookup(pool_id, hash, saved_map);
+  if (!map.is_null()) {
+    bytes_ += length;
+    Synchronize();
+    return map;
+  }
+
+  int context_dependent_loads = context_dependent_loads_;
+  loaded_maps_.Clear();
+  loading_map_ = true;
+  MaybeHandle<Map> maybe_map = MapLoader(this).LoadMap();
+  loading_map_ = false;
+  if (maybe_map.ToHandle(&map)) {
+    DCHECK(bytes_ == saved_map.end());
+    // A map whose record names functions of the closure's context chain
+    // can't be reused by chunks from other contexts.
+    if (context_dependent_loads == context_dependent_loads_) {
+      cache->Add(pool_id, hash, saved_map, map);
+    }
     Synchronize();
     return map;
   }
@@ -1,9 +1,11 @@
 #ifndef V8_LITHIUM_SAVELOAD_H_
 #define V8_LITHIUM_SAVELOAD_H_
 
+#include "src/code-block-database.h"
 #include "src/lithium.h"
 #include "src/saveload.h"
 
+#include "src/hashmap.h"
 #include "src/list.h"
 #include "src/vector.h"
 
@@ -69,9 +71,22 @@ class LChunkSaveloadBase BASE_EMBEDDED {
 
 class LChunkSaverBase : public LChunkSaveloadBase {
  public:
-  LChunkSaverBase(List<char>& bytes, CompilationInfo* info)
+  // Strings and heap numbers are added to |constants|, if given, instead of
+  // being saved along with the chunk.
+  LChunkSaverBase(List<char>& bytes, CompilationInfo* info,
+                  SavedConstantPool* constants)
       : bytes_(bytes),
-        info_(info) {}
+        info_(info),
+        constants_(constants),
+        strings_(HashMap::PointersMatch),
+        leave_out_ids_(false),
+        last_block_id_(0),
+        last_value_id_(0) {}
+
+  // Values and blocks are numbered differently in every chunk, so what is
+  // saved only to be compared with another chunk (see LChunkValidator)
+  // leaves their ids out.
+  void LeaveOutIds() { leave_out_ids_ = true; }
 
   void SaveBitVector(const BitVector*);
   void SaveObject(Object*); // Handles heap objects, SMIs, and nulls.
@@ -86,6 +101,7 @@ class LChunkSaverBase : public LChunkSaveloadBase {
   void SaveJSRegExp(JSRegExp*);
   void SaveFixedArrayBase(FixedArrayBase*);
   void SaveFixedArray(FixedArray*);
+  void SaveScopeInfo(ScopeInfo*);
   void SaveFixedDoubleArray(FixedDoubleArray*);
   void SaveJSArray(JSArray*);
   void SaveJSArrayBuffer(JSArrayBuffer*);
@@ -117,12 +133,31 @@ class LChunkSaverBase : public LChunkSaveloadBase {
  protected:
   template<typename T>
   void SavePrimitiveArray(Vector<const T> array) {
-    internal::SavePrimitiveArray<T>(bytes_, array);
+    internal::SaveCompactArray<T>(bytes_, array);
   }
 
   template<typename T>
   void SavePrimitive(T value) {
-    internal::SavePrimitive<T>(bytes_, value);
+    internal::SaveCompact<T>(bytes_, value);
+  }
+
+  // Block and value ids mostly repeat or grow by small steps from one use
+  // to the next, so they are saved relative to the previous one.
+  void SaveBlockId(int block_id) {
+    if (leave_out_ids_) return;
+    SaveDelta(block_id, &last_block_id_);
+  }
+
+  void SaveValueId(int value_id) {
+    if (leave_out_ids_) return;
+    SaveDelta(value_id, &last_value_id_);
+  }
+
+  bool leaves_out_ids() const { return leave_out_ids_; }
+
+  void SaveDelta(int value, int* previous) {
+    SavePrimitive<int>(value - *previous);
+    *previous = value;
   }
 
   void SaveTrue() {
@@ -141,13 +176,29 @@ class LChunkSaverBase : public LChunkSaveloadBase {
 
  private:
   void SaveFixedArrayData(FixedArray*);
+  void SaveStringData(Vector<const char> data, bool internalized);
+  void SaveConstant(SavedConstantPool::Kind kind, Vector<const char> data);
 
   class MapSaver;
   friend class MapSaver;
 
   List<char>& bytes_;
   CompilationInfo* info_;
+  // Maps being saved, innermost last.
   List<Map*> map_cache_;
+  // Maps saved since the current top-level SaveMap started, in the order
+  // they were entered.  Later references to them are saved as indices into
+  // this list, which the loader rebuilds in the same order.
+  List<Map*> saved_maps_;
+  SavedConstantPool* constants_;
+
+  // Internalized strings saved so far, mapped to their index in
+  // |constants_|, so that they don't have to be converted to UTF-8 again.
+  HashMap strings_;
+
+  bool leave_out_ids_;
+  int last_block_id_;
+  int last_value_id_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(LChunkSaverBase);
 };
@@ -155,11 +206,17 @@ class LChunkSaverBase : public LChunkSaveloadBase {
 
 class LChunkLoaderBase : public LChunkSaveloadBase {
  public:
-  LChunkLoaderBase(const List<char>& bytes, CompilationInfo* info)
+  LChunkLoaderBase(Vector<const char> bytes, CompilationInfo* info,
+                   const SavedConstantPool* constants)
       : chunk_(nullptr),
         storage_(bytes),
-        bytes_(storage_.begin()),
-        info_(info) {}
+        bytes_(storage_.start()),
+        info_(info),
+        constants_(constants),
+        context_dependent_loads_(0),
+        loading_map_(false),
+        last_block_id_(0),
+        last_value_id_(0) {}
 
   void LoadBitVector(BitVector*);
   Handle<Object> LoadObject(); // Handles heap objects, SMIs, and nulls.
@@ -176,6 +233,7 @@ class LChunkLoaderBase : public LChunkSaveloadBase {
   Handle<JSRegExp> LoadJSRegExp();
   Handle<FixedArrayBase> LoadFixedArrayBase();
   Handle<FixedArray> LoadFixedArray();
+  Handle<ScopeInfo> LoadScopeInfo();
   Handle<FixedDoubleArray> LoadFixedDoubleArray();
   Handle<JSArray> LoadJSArray();
   Handle<JSArrayBuffer> LoadJSArrayBuffer();
@@ -200,7 +258,7 @@ class LChunkLoaderBase : public LChunkSaveloadBase {
   LPointerMap* LoadPointerMap();
 
   LChunk* chunk() { return chunk_; }
-  const char* start() const { return storage_.begin(); }
+  const char* start() const { return storage_.start(); }
   const char** bytes() { return &bytes_; }
   CompilationInfo* info() { return info_; }
   Isolate* isolate() { return info_->isolate(); }
@@ -211,12 +269,25 @@ class LChunkLoaderBase : public LChunkSaveloadBase {
 
   template<typename T>
   Vector<const T> LoadPrimitiveArray() {
-    return internal::LoadPrimitiveArray<T>(&bytes_);
+    return internal::LoadCompactArray<T>(&bytes_);
   }
 
   template<typename T>
   T LoadPrimitive() {
-    return internal::LoadPrimitive<T>(&bytes_);
+    return internal::LoadCompact<T>(&bytes_);
+  }
+
+  int LoadBlockId() {
+    return LoadDelta(&last_block_id_);
+  }
+
+  int LoadValueId() {
+    return LoadDelta(&last_value_id_);
+  }
+
+  int LoadDelta(int* previous) {
+    *previous += LoadPrimitive<int>();
+    return *previous;
   }
 
   bool LoadBool() {
@@ -232,15 +303,29 @@ class LChunkLoaderBase : public LChunkSaveloadBase {
   }
 
  private:
-  void LoadFixedArrayData(FixedArray*);
+  void LoadFixedArrayData(Handle<FixedArray>);
+  Handle<Object> LoadConstant(SavedConstantPool::Kind kind);
 
   class MapLoader;
   friend class MapLoader;
 
   LChunk* chunk_;
-  const List<char>& storage_;
+  Vector<const char> storage_;
   const char* bytes_;
   CompilationInfo* info_;
+  const SavedConstantPool* constants_;
+  // The constants of |constants_| materialized in this isolate.
+  Handle<FixedArray> materialized_constants_;
+  // Objects loaded relative to the closure's context, which keep the maps
+  // whose records refer to them out of the SavedMapCache.
+  int context_dependent_loads_;
+  // Whether a top-level LoadMap is in progress, and the maps it has created
+  // so far (see LChunkSaverBase::saved_maps_).
+  bool loading_map_;
+  List<Handle<Map> > loaded_maps_;
+
+  int last_block_id_;
+  int last_value_id_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(LChunkLoaderBase);
 };
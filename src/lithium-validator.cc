@@ -0,0 +1,279 @@
+#include "src/lithium-validator.h"
+
+#if V8_TARGET_ARCH_X64
+#include "src/x64/lithium-x64.h"  // NOLINT
+#include "src/x64/lithium-saveload-x64.h"  // NOLINT
+#else
+#error Unsupported target architecture.
+#endif
+
+namespace v8 {
+namespace internal {
+
+bool LChunkValidator::Validate() {
+  const ZoneList<LInstruction*>* expected = expected_->instructions();
+  const ZoneList<LInstruction*>* actual = actual_->instructions();
+  if (expected_->spill_slot_count() != actual_->spill_slot_count()) {
+    return Fail("spill slot count");
+  }
+  if (expected->length() != actual->length()) {
+    return Fail("instruction count");
+  }
+
+  // The hydrogen shims are compared in the form they are saved in.
+  List<char> expected_shims;
+  List<char> actual_shims;
+  LChunkSaver expected_saver(expected_shims, expected_->info(), nullptr);
+  LChunkSaver actual_saver(actual_shims, actual_->info(), nullptr);
+  expected_saver.LeaveOutIds();
+  actual_saver.LeaveOutIds();
+  expected_shims_ = &expected_shims;
+  actual_shims_ = &actual_shims;
+  expected_saver_ = &expected_saver;
+  actual_saver_ = &actual_saver;
+
+  bool same = true;
+  for (int i = 0; same && i < expected->length(); ++i) {
+    instruction_index_ = i;
+    same = SameInstruction(expected->at(i), actual->at(i));
+  }
+  expected_shims_ = nullptr;
+  actual_shims_ = nullptr;
+  expected_saver_ = nullptr;
+  actual_saver_ = nullptr;
+  if (same) {
+    instruction_index_ = -1;
+  }
+  return same;
+}
+
+
+const char* LChunkValidator::ExpectedMnemonic() const {
+  if (instruction_index_ < 0) {
+    return "-";
+  }
+  return expected_->instructions()->at(instruction_index_)->Mnemonic();
+}
+
+
+const char* LChunkValidator::ActualMnemonic() const {
+  if (instruction_index_ < 0) {
+    return "-";
+  }
+  return actual_->instructions()->at(instruction_index_)->Mnemonic();
+}
+
+
+bool LChunkValidator::SameInstruction(LInstruction* expected,
+                                      LInstruction* actual) {
+  if (strcmp(expected->Mnemonic(), actual->Mnemonic()) != 0) {
+    return Fail("instruction");
+  }
+
+  if (expected->HasResult() != actual->HasResult() ||
+      (expected->HasResult() &&
+       !SameOperand(expected->result(), actual->result()))) {
+    return Fail("result");
+  }
+  if (expected->InputCount() != actual->InputCount()) {
+    return Fail("input count");
+  }
+  for (int i = 0; i < expected->InputCount(); ++i) {
+    if (!SameOperand(expected->InputAt(i), actual->InputAt(i))) {
+      return Fail("input");
+    }
+  }
+  if (expected->TempCount() != actual->TempCount()) {
+    return Fail("temp count");
+  }
+  for (int i = 0; i < expected->TempCount(); ++i) {
+    if (!SameOperand(expected->TempAt(i), actual->TempAt(i))) {
+      return Fail("temp");
+    }
+  }
+
+  if (!SameEnvironment(expected->environment(), actual->environment())) {
+    return Fail("environment");
+  }
+  if (expected->HasPointerMap() != actual->HasPointerMap() ||
+      (expected->HasPointerMap() &&
+       !SamePointerMap(expected->pointer_map(), actual->pointer_map()))) {
+    return Fail("pointer map");
+  }
+  if (expected->IsGap() && !SameGap(expected, actual)) {
+    return Fail("gap moves");
+  }
+  if (!SameHydrogenShim(expected, actual)) {
+    return Fail("hydrogen shim");
+  }
+  return true;
+}
+
+
+bool LChunkValidator::SameHydrogenShim(LInstruction* expected,
+                                       LInstruction* actual) {
+  // Constant instructions save only the ids of their constants.
+#define SAME_CONSTANT_SHIM(type)                                    \
+  if (expected->Is##type()) {                                       \
+    return SameConstant(L##type::cast(expected)->hydrogen_shim(),   \
+                        L##type::cast(actual)->hydrogen_shim());    \
+  }
+  LITHIUM_CONSTANT_INSTRUCTION_LIST(SAME_CONSTANT_SHIM)
+#undef SAME_CONSTANT_SHIM
+
+  int expected_start = expected_shims_->length();
+  int actual_start = actual_shims_->length();
+  expected->SaveHydrogenShimTo(expected_saver_);
+  actual->SaveHydrogenShimTo(actual_saver_);
+  if (expected_saver_->LastStatus() != actual_saver_->LastStatus()) {
+    return false;
+  }
+  if (expected_saver_->LastStatus() != LChunkSaverBase::SUCCEEDED) {
+    // Failing to save is sticky, so the shims that follow aren't compared.
+    return true;
+  }
+  Vector<const char> expected_shim = expected_shims_->ToConstVector().SubVector(
+      expected_start, expected_shims_->length());
+  Vector<const char> actual_shim = actual_shims_->ToConstVector().SubVector(
+      actual_start, actual_shims_->length());
+  return expected_shim == actual_shim;
+}
+
+
+bool LChunkValidator::SameOperand(LOperand* expected, LOperand* actual) {
+  if (expected == NULL || actual == NULL) {
+    return expected == actual;
+  }
+  if (expected->kind() != actual->kind()) {
+    return false;
+  }
+  if (!expected->IsConstantOperand()) {
+    return expected->index() == actual->index();
+  }
+
+  LConstantOperand* expected_constant = LConstantOperand::cast(expected);
+  LConstantOperand* actual_constant = LConstantOperand::cast(actual);
+  if (!expected_->LookupLiteralRepresentation(expected_constant).Equals(
+          actual_->LookupLiteralRepresentation(actual_constant))) {
+    return false;
+  }
+  return SameConstant(expected_->LookupConstant(expected_constant),
+                      actual_->LookupConstant(actual_constant));
+}
+
+
+bool LChunkValidator::SameConstant(HConstantShim* expected,
+                                   HConstantShim* actual) {
+  if (expected->HasInteger32Value() != actual->HasInteger32Value() ||
+      expected->HasDoubleValue() != actual->HasDoubleValue() ||
+      expected->HasExternalReferenceValue() !=
+          actual->HasExternalReferenceValue()) {
+    return false;
+  }
+  if (expected->HasDoubleValue()) {
+    // Numbers may be boxed in different heap numbers; -0 and NaNs are told
+    // apart by their bits.
+    return bit_cast<uint64_t>(expected->DoubleValue()) ==
+           bit_cast<uint64_t>(actual->DoubleValue());
+  }
+  if (expected->HasExternalReferenceValue()) {
+    return expected->ExternalReferenceValue().address() ==
+           actual->ExternalReferenceValue().address();
+  }
+
+  Handle<Object> expected_object = expected->GetUnique().handle();
+  Handle<Object> actual_object = actual->GetUnique().handle();
+  if (expected_object.is_null() || actual_object.is_null()) {
+    return expected_object.is_null() == actual_object.is_null();
+  }
+  if (*expected_object == *actual_object) {
+    return true;
+  }
+  // The constant elements of array literals are only passed to the runtime
+  // when the code is saved, see HOptimizedGraphBuilder::VisitArrayLiteral.
+  return expected_object->IsFixedArray() && actual_object->IsFixedArray();
+}
+
+
+bool LChunkValidator::SameEnvironment(LEnvironment* expected,
+                                      LEnvironment* actual) {
+  for (; expected != NULL && actual != NULL;
+       expected = expected->outer(), actual = actual->outer()) {
+    if (expected->ast_id() != actual->ast_id() ||
+        expected->frame_type() != actual->frame_type() ||
+        expected->parameter_count() != actual->parameter_count() ||
+        expected->translation_size() != actual->translation_size() ||
+        expected->closure()->shared() != actual->closure()->shared()) {
+      return false;
+    }
+    const ZoneList<LOperand*>* expected_values = expected->values();
+    const ZoneList<LOperand*>* actual_values = actual->values();
+    if (expected_values->length() != actual_values->length()) {
+      return false;
+    }
+    for (int i = 0; i < expected_values->length(); ++i) {
+      if (!SameOperand(expected_values->at(i), actual_values->at(i))) {
+        return false;
+      }
+    }
+  }
+  return expected == NULL && actual == NULL;
+}
+
+
+bool LChunkValidator::SamePointerMap(LPointerMap* expected,
+                                     LPointerMap* actual) {
+  const ZoneList<LOperand*>* expected_operands =
+      expected->GetNormalizedOperands();
+  const ZoneList<LOperand*>* actual_operands =
+      actual->GetNormalizedOperands();
+  if (expected_operands->length() != actual_operands->length()) {
+    return false;
+  }
+  for (int i = 0; i < expected_operands->length(); ++i) {
+    if (!SameOperand(expected_operands->at(i), actual_operands->at(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// Collects the moves of |gap| that the gap resolver doesn't skip.
+static void CollectMoves(LGap* gap, List<const LMoveOperands*>* moves) {
+  for (int i = LGap::FIRST_INNER_POSITION; i <= LGap::LAST_INNER_POSITION;
+       ++i) {
+    const LParallelMove* move =
+        gap->GetParallelMove(static_cast<LGap::InnerPosition>(i));
+    if (move == NULL) {
+      continue;
+    }
+    const ZoneList<LMoveOperands>* operands = move->move_operands();
+    for (int j = 0; j < operands->length(); ++j) {
+      if (!operands->at(j).IsRedundant()) {
+        moves->Add(&operands->at(j));
+      }
+    }
+  }
+}
+
+
+bool LChunkValidator::SameGap(LInstruction* expected, LInstruction* actual) {
+  List<const LMoveOperands*> expected_moves;
+  List<const LMoveOperands*> actual_moves;
+  CollectMoves(LGap::cast(expected), &expected_moves);
+  CollectMoves(LGap::cast(actual), &actual_moves);
+  if (expected_moves.length() != actual_moves.length()) {
+    return false;
+  }
+  for (int i = 0; i < expected_moves.length(); ++i) {
+    if (!SameOperand(expected_moves[i]->source(), actual_moves[i]->source()) ||
+        !SameOperand(expected_moves[i]->destination(),
+                     actual_moves[i]->destination())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} }  // namespace v8::internal
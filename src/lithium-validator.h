@@ -0,0 +1,79 @@
+#ifndef V8_LITHIUM_VALIDATOR_H_
+#define V8_LITHIUM_VALIDATOR_H_
+
+#include "src/lithium.h"
+
+namespace v8 {
+namespace internal {
+
+class HConstantShim;
+class LChunkSaver;
+
+// Compares a chunk loaded from a code block database with the chunk
+// Crankshaft builds for the same function in the loading isolate (see
+// --saveload-validate), to find loaded code that no longer matches what the
+// JIT would generate, e.g. after a change of maps or object layouts.
+//
+// The chunks are compared instruction by instruction: the mnemonics, the
+// allocated operands, the values of constant operands, the deoptimization
+// environments, the pointer maps, the moves of the gaps and the hydrogen
+// shims, which hold e.g. the maps, field accesses and elements kinds the code
+// is specialized for.  Shims are compared in the form LChunkSaver saves them
+// in, without the value and block ids.  Constants are compared by value,
+// since the ids of the values they are defined by differ between the chunks.
+// Both chunks must be compared before their code is generated.
+class LChunkValidator {
+ public:
+  // |expected| is the freshly built chunk, |actual| the loaded one.
+  LChunkValidator(LChunk* expected, LChunk* actual)
+      : expected_(expected),
+        actual_(actual),
+        reason_(nullptr),
+        instruction_index_(-1),
+        expected_shims_(nullptr),
+        actual_shims_(nullptr),
+        expected_saver_(nullptr),
+        actual_saver_(nullptr) {}
+
+  // Returns false if the chunks differ, in which case Reason() says how,
+  // and InstructionIndex() where.
+  bool Validate();
+
+  const char* Reason() const { return reason_; }
+  // -1 if the chunks differ as a whole.
+  int InstructionIndex() const { return instruction_index_; }
+  // The mnemonics of the instructions at InstructionIndex(), or "-".
+  const char* ExpectedMnemonic() const;
+  const char* ActualMnemonic() const;
+
+ private:
+  bool SameInstruction(LInstruction* expected, LInstruction* actual);
+  bool SameOperand(LOperand* expected, LOperand* actual);
+  bool SameConstant(HConstantShim* expected, HConstantShim* actual);
+  bool SameEnvironment(LEnvironment* expected, LEnvironment* actual);
+  bool SamePointerMap(LPointerMap* expected, LPointerMap* actual);
+  bool SameGap(LInstruction* expected, LInstruction* actual);
+  bool SameHydrogenShim(LInstruction* expected, LInstruction* actual);
+
+  bool Fail(const char* reason) {
+    reason_ = reason;
+    return false;
+  }
+
+  LChunk* expected_;
+  LChunk* actual_;
+  const char* reason_;
+  int instruction_index_;
+
+  // Where the hydrogen shims are saved to while validating.
+  List<char>* expected_shims_;
+  List<char>* actual_shims_;
+  LChunkSaver* expected_saver_;
+  LChunkSaver* actual_saver_;
+
+  DISALLOW_COPY_AND_ASSIGN(LChunkValidator);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_LITHIUM_VALIDATOR_H_
@@ -498,18 +498,64 @@ LChunk* LChunk::NewChunk(HGraph* graph) {
 }
 
 
-bool LSavedChunk::Save(LChunk* chunk) {
+bool LSavedChunk::Save(LChunk* chunk, Handle<Code> code) {
   DCHECK(chunk);
   DCHECK(!bytes_.length());
-  LChunkSaver saver(bytes_, chunk->info());
+
+  // An empty array stands for no machine code.
+  List<char> machine_code;
+  if (FLAG_saveload_machine_code && !code.is_null()) {
+    LChunkSaver saver(machine_code, chunk->info(), constants_);
+    saver.SaveCode(chunk, *code);
+    if (saver.LastStatus() != LChunkSaverBase::SUCCEEDED) {
+      if (FLAG_trace_saveload) {
+        PrintF("[machine code for %d not saved, reason: %s]\n",
+               chunk->info()->shared_info()->start_position(),
+               saver.Reason());
+      }
+      machine_code.Clear();
+    }
+  }
+  SaveCompactArray<char>(bytes_, machine_code.ToConstVector());
+
+  LChunkSaver saver(bytes_, chunk->info(), constants_);
   saver.Save(chunk);
   reason_ = saver.Reason();
   return saver.LastStatus() == LChunkSaverBase::SUCCEEDED;
 }
 
 
+bool LSavedChunk::SaveCode(CompilationInfo* info, Handle<Code> code) {
+  DCHECK(!bytes_.length());
+
+  List<char> machine_code;
+  LChunkSaver saver(machine_code, info, constants_);
+  saver.SaveCode(nullptr, *code);
+  reason_ = saver.Reason();
+  if (saver.LastStatus() != LChunkSaverBase::SUCCEEDED) {
+    return false;
+  }
+  SaveCompactArray<char>(bytes_, machine_code.ToConstVector());
+  return true;
+}
+
+
+Vector<const char> LSavedChunk::MachineCode() const {
+  const char* bytes = code_.start();
+  return LoadCompactArray<char>(&bytes);
+}
+
+
+Vector<const char> LSavedChunk::Lithium() const {
+  Vector<const char> machine_code = MachineCode();
+  const char* start = machine_code.start() + machine_code.length();
+  return Vector<const char>(start, code_.length() -
+                                   static_cast<int>(start - code_.start()));
+}
+
+
 LChunk* LSavedChunk::Load(CompilationInfo* info) const {
-  LChunkLoader loader(bytes_, info);
+  LChunkLoader loader(Lithium(), info, loaded_constants_);
   LChunk* chunk = loader.Load();
   reason_ = loader.Reason();
   DCHECK(chunk || reason_);
@@ -517,8 +563,28 @@ LChunk* LSavedChunk::Load(CompilationInfo* info) const {
 }
 
 
+Handle<Code> LSavedChunk::LoadCode(CompilationInfo* info) const {
+  reason_ = nullptr;
+  Vector<const char> machine_code = MachineCode();
+  if (machine_code.is_empty()) {
+    return Handle<Code>::null();
+  }
+  LChunkLoader loader(machine_code, info, loaded_constants_);
+  Handle<Code> code = loader.LoadCode();
+  reason_ = loader.Reason();
+  DCHECK(!code.is_null() || reason_);
+  return code;
+}
+
+
 Handle<Code> LChunk::Codegen() {
   MacroAssembler assembler(info()->isolate(), NULL, 0);
+  // External references outside of the isolate may otherwise be addressed
+  // relative to the root register, without relocation information, which
+  // would make the saved machine code impossible to relocate.
+  if (FLAG_saveload_machine_code && Compiler::WillSaveOptimizedCode(info())) {
+    assembler.set_predictable_code_size(true);
+  }
   LOG_CODE_EVENT(info()->isolate(),
                  CodeStartLinePosInfoRecordEvent(
                      assembler.positions_recorder()));
@@ -708,6 +708,9 @@ class LChunk : public ZoneObject {
 
   void CommitDependencies(Handle<Code> code) const;
 
+  // Saves the dependencies along with the machine code.
+  friend class LChunkSaver;
+
   CompilationInfo* info_;
   HGraph* const graph_;
   ZoneList<HValueShim*> values_;
@@ -720,22 +723,52 @@ class LChunk : public ZoneObject {
 };
 
 
+// A saved chunk consists of the machine code generated from it, which is
+// optional (see --saveload-machine-code), followed by the Lithium IR.  The
+// machine code is only saved if everything it refers to can be relocated;
+// otherwise, or if it can't be relocated on load after all, the Lithium IR
+// is loaded and the code is generated again.
+//
+// TurboFan code, e.g. that of asm.js functions, has no chunk, so only its
+// machine code is saved and the Lithium IR is left empty.
 class LSavedChunk {
  public:
-  LSavedChunk() {}
-
-  LSavedChunk(Vector<const char> code) {
-    bytes_.AddAll(code);
-  }
-
-  bool Save(LChunk* chunk);
+  // Constants are saved to |constants| rather than with the chunk.
+  explicit LSavedChunk(SavedConstantPool* constants)
+      : constants_(constants),
+        loaded_constants_(nullptr),
+        reason_(nullptr) {}
+
+  // The code is not copied, so it must outlive the chunk, and so must the
+  // pool of the constants it refers to.
+  LSavedChunk(Vector<const char> code, const SavedConstantPool* constants)
+      : code_(code),
+        constants_(nullptr),
+        loaded_constants_(constants),
+        reason_(nullptr) {}
+
+  // |code| is the code generated from |chunk|, if any.
+  bool Save(LChunk* chunk, Handle<Code> code);
+  // Saves the machine code of TurboFan |code|.
+  bool SaveCode(CompilationInfo* info, Handle<Code> code);
   LChunk* Load(CompilationInfo* info) const;
+  // Returns a null handle if there is no machine code, or if it can't be
+  // relocated, in which case Reason() says why.
+  Handle<Code> LoadCode(CompilationInfo* info) const;
   Vector<const char> GetCode() { return bytes_.Detach(); }
+  // False for TurboFan code, which can only be loaded with LoadCode.
+  bool HasLithium() const { return !Lithium().is_empty(); }
 
   const char* Reason() const { return reason_; }
 
  private:
-  List<char> bytes_;
+  Vector<const char> MachineCode() const;
+  Vector<const char> Lithium() const;
+
+  List<char> bytes_;  // Used for saving.
+  Vector<const char> code_;  // Used for loading.
+  SavedConstantPool* constants_;  // Used for saving.
+  const SavedConstantPool* loaded_constants_;  // Used for loading.
   mutable const char* reason_;
 };
 
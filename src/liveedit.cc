@@ -847,6 +847,7 @@ MaybeHandle<JSArray> LiveEdit::GatherCompileInfo(Handle<Script> script,
   Handle<Object> original_source =
       Handle<Object>(script->source(), isolate);
   script->set_source(*source);
+  script->set_source_hash(isolate->heap()->undefined_value());
   isolate->set_active_function_info_listener(&listener);
 
   {
@@ -896,6 +897,7 @@ MaybeHandle<JSArray> LiveEdit::GatherCompileInfo(Handle<Script> script,
   // A logical 'finally' section.
   isolate->set_active_function_info_listener(NULL);
   script->set_source(*original_source);
+  script->set_source_hash(isolate->heap()->undefined_value());
 
   if (rethrow_exception.is_null()) {
     return listener.GetResult();
@@ -1483,8 +1485,9 @@ Handle<Object> LiveEdit::ChangeScriptSource(Handle<Script> original_script,
 
   original_script->set_source(*new_source);
 
-  // Drop line ends so that they will be recalculated.
+  // Drop line ends and source hash so that they will be recalculated.
   original_script->set_line_ends(isolate->heap()->undefined_value());
+  original_script->set_source_hash(isolate->heap()->undefined_value());
 
   return old_script_object;
 }
@@ -19,6 +19,7 @@
 #include "src/list.h"
 #include "src/natives.h"
 #include "src/serialize.h"
+#include "src/snapshot.h"
 
 
 using namespace v8;
@@ -63,6 +64,12 @@ class SnapshotWriter {
       startup_blob_file_ = GetFileDescriptorOrDie(startup_blob_file);
   }
 
+  // The database is neither compressed nor decoded, so that it can be used
+  // in place at startup.
+  void SetCodeDatabase(i::Vector<const char> code_database) {
+    code_database_ = code_database;
+  }
+
   void WriteSnapshot(const i::List<i::byte>& snapshot_data,
                      const i::Serializer& serializer,
                      const i::List<i::byte>& context_snapshot_data,
@@ -109,6 +116,11 @@ class SnapshotWriter {
       sink.PutInt(chunks[0], "spaces");
     }
 
+    sink.PutAlignedBlob(reinterpret_cast<i::byte*>(
+                            const_cast<char*>(code_database_.start())),
+                        code_database_.length(),
+                        i::Snapshot::kCodeDatabaseAlignment, "code database");
+
     const i::List<i::byte>& startup_blob = sink.data();
     size_t written = fwrite(startup_blob.begin(), 1, startup_blob.length(),
                             startup_blob_file_);
@@ -127,6 +139,7 @@ class SnapshotWriter {
     WriteData("context_", context_snapshot_data, raw_context_file_);
     WriteMeta("context_", context_serializer);
     WriteMeta("", serializer);
+    WriteCodeDatabase();
     WriteFileSuffix();
   }
 
@@ -221,6 +234,23 @@ class SnapshotWriter {
             chunks[0]);
   }
 
+  void WriteCodeDatabase() const {
+    fprintf(fp_, "V8_ALIGNED(%d) const byte Snapshot::code_database_data_[] = "
+                 "{\n", i::Snapshot::kCodeDatabaseAlignment);
+    if (code_database_.is_empty()) {
+      fprintf(fp_, "0\n");
+    } else {
+      i::List<i::byte> data(code_database_.length());
+      data.AddAll(i::Vector<const i::byte>(
+          reinterpret_cast<const i::byte*>(code_database_.start()),
+          code_database_.length()));
+      WriteSnapshotData(&data);
+    }
+    fprintf(fp_, "};\n");
+    fprintf(fp_, "const int Snapshot::code_database_size_ = %d;\n\n",
+            code_database_.length());
+  }
+
   void WriteSnapshotData(const i::List<i::byte>* data) const {
     for (int i = 0; i < data->length(); i++) {
       if ((i & 0x1f) == 0x1f)
@@ -246,6 +276,7 @@ class SnapshotWriter {
   FILE* raw_context_file_;
   FILE* startup_blob_file_;
   Compressor* compressor_;
+  i::Vector<const char> code_database_;
 };
 
 
@@ -346,6 +377,16 @@ int main(int argc, char** argv) {
 #endif
   i::FLAG_logfile_per_isolate = false;
 
+  i::Vector<const char> code_database;
+  if (i::FLAG_embed_code != NULL) {
+    bool exists;
+    code_database = i::ReadFile(i::FLAG_embed_code, &exists, false);
+    if (!exists) {
+      fprintf(stderr, "Failed to read '%s'\n", i::FLAG_embed_code);
+      exit(1);
+    }
+  }
+
   Isolate::CreateParams params;
   params.enable_serializer = true;
   Isolate* isolate = v8::Isolate::New(params);
@@ -437,6 +478,8 @@ int main(int argc, char** argv) {
         writer.SetRawFiles(i::FLAG_raw_file, i::FLAG_raw_context_file);
       if (i::FLAG_startup_blob)
         writer.SetStartupBlobFile(i::FLAG_startup_blob);
+      if (code_database.length() > 0)
+        writer.SetCodeDatabase(code_database);
   #ifdef COMPRESS_STARTUP_DATA_BZ2
       BZip2Compressor bzip2;
       writer.SetCompressor(&bzip2);
@@ -446,6 +489,7 @@ int main(int argc, char** argv) {
     }
   }
 
+  code_database.Dispose();
   isolate->Dispose();
   V8::Dispose();
   V8::ShutdownPlatform();
@@ -1002,6 +1002,7 @@ void Script::ScriptVerify() {
   type()->SmiVerify();
   VerifyPointer(line_ends());
   VerifyPointer(id());
+  CHECK(source_hash()->IsUndefined() || source_hash()->IsSmi());
 }
 
 
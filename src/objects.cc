@@ -9600,19 +9600,30 @@ void SharedFunctionInfo::EvictFromOptimizedCodeMap(Code* optimized_code,
 
 
 void SharedFunctionInfo::DiscardSavedOptimizedCode(const char* reason) {
-  if (FLAG_save_code) {
-    if (!Compiler::DiscardCodeFromCodeBlockDatabase(start_position())) {
-      return;
+  // Code that deoptimizes is not saved, whatever the limit below.
+  bool discarded = Compiler::IsSavingCode() &&
+                   Compiler::DiscardCodeFromCodeBlockDatabase(this);
+
+  if (Compiler::IsLoadingCode() && has_saved_optimized_code()) {
+    // A function that deoptimizes on a rare path still gets its loaded code
+    // back when it is optimized again.
+    if (deopt_count() < FLAG_saveload_deopt_limit) {
+      if (FLAG_trace_saveload) {
+        PrintF("[keeping saved optimized code (%s) for ", reason);
+        ShortPrint();
+        PrintF(" at start position %d, %d deopts]\n", start_position(),
+               deopt_count());
+      }
+    } else {
+      set_has_saved_optimized_code(false);
+      discarded = true;
     }
   }
 
-  if (FLAG_load_code) {
-    if (!has_saved_optimized_code()) {
-      return;
-    }
-    set_has_saved_optimized_code(false);
+  if (!discarded) {
+    return;
   }
-
+  GetIsolate()->counters()->saveload_discarded_by_deopt()->Increment();
   if (FLAG_trace_saveload) {
     PrintF("[discarding saved optimized code (%s) for ", reason);
     ShortPrint();
@@ -10031,6 +10042,28 @@ int Script::GetLineNumber(int code_pos) {
 }
 
 
+int Script::GetSourceHash() {
+  DisallowHeapAllocation no_allocation;
+  if (source_hash()->IsSmi()) return Smi::cast(source_hash())->value();
+
+  // The hash has to be the same in every run, so the heap's hash seed can't
+  // be used here.  Also, String::Hash only looks at the length of long
+  // strings, and scripts usually are long.
+  uint32_t running_hash = 0;
+  if (source()->IsString()) {
+    StringCharacterStream stream(String::cast(source()));
+    while (stream.HasMore()) {
+      running_hash =
+          StringHasher::AddCharacterCore(running_hash, stream.GetNext());
+    }
+  }
+  int hash = static_cast<int>(StringHasher::GetHashCore(running_hash) &
+                              static_cast<uint32_t>(Smi::kMaxValue));
+  set_source_hash(Smi::FromInt(hash));
+  return hash;
+}
+
+
 Handle<Object> Script::GetNameOrSourceURL(Handle<Script> script) {
   Isolate* isolate = script->GetIsolate();
   Handle<String> name_or_source_url_key =
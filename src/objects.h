@@ -5087,6 +5087,11 @@ class Code: public HeapObject {
   inline bool is_turbofanned();
   inline void set_is_turbofanned(bool value);
 
+  // [is_loaded_code]: For kind OPTIMIZED_FUNCTION, tells whether the code
+  // object was loaded from a code block database rather than compiled.
+  inline bool is_loaded_code();
+  inline void set_is_loaded_code(bool value);
+
   // [optimizable]: For FUNCTION kind, tells if it is optimizable.
   inline bool optimizable();
   inline void set_optimizable(bool value);
@@ -5410,9 +5415,10 @@ class Code: public HeapObject {
   static const int kWeakStubBit = kMarkedForDeoptimizationBit + 1;
   static const int kInvalidatedWeakStubBit = kWeakStubBit + 1;
   static const int kIsTurbofannedBit = kInvalidatedWeakStubBit + 1;
+  static const int kIsLoadedCodeBit = kIsTurbofannedBit + 1;
 
   STATIC_ASSERT(kStackSlotsFirstBit + kStackSlotsBitCount <= 32);
-  STATIC_ASSERT(kIsTurbofannedBit + 1 <= 32);
+  STATIC_ASSERT(kIsLoadedCodeBit + 1 <= 32);
 
   class StackSlotsField: public BitField<int,
       kStackSlotsFirstBit, kStackSlotsBitCount> {};  // NOLINT
@@ -5425,6 +5431,8 @@ class Code: public HeapObject {
       : public BitField<bool, kInvalidatedWeakStubBit, 1> {};  // NOLINT
   class IsTurbofannedField : public BitField<bool, kIsTurbofannedBit, 1> {
   };  // NOLINT
+  class IsLoadedCodeField : public BitField<bool, kIsLoadedCodeBit, 1> {
+  };  // NOLINT
 
   // KindSpecificFlags2 layout (ALL)
   static const int kIsCrankshaftedBit = 0;
@@ -6513,6 +6521,10 @@ class Script: public Struct {
   // [source_url]: sourceMappingURL magic comment
   DECL_ACCESSORS(source_mapping_url, Object)
 
+  // [source_hash]: hash of the source contents used to look up saved
+  // optimized code, or undefined if it has not been computed yet.
+  DECL_ACCESSORS(source_hash, Object)
+
   // [compilation_type]: how the the script was compiled. Encoded in the
   // 'flags' field.
   inline CompilationType compilation_type();
@@ -6545,6 +6557,10 @@ class Script: public Struct {
 
   static Handle<Object> GetNameOrSourceURL(Handle<Script> script);
 
+  // Hash of the source contents, stable across runs.  Computed on first use
+  // and cached in the script.  Does not allocate.
+  int GetSourceHash();
+
   // Init line_ends array with code positions of line ends inside script source.
   static void InitLineEnds(Handle<Script> script);
 
@@ -6571,7 +6587,8 @@ class Script: public Struct {
       kEvalFrominstructionsOffsetOffset + kPointerSize;
   static const int kSourceUrlOffset = kFlagsOffset + kPointerSize;
   static const int kSourceMappingUrlOffset = kSourceUrlOffset + kPointerSize;
-  static const int kSize = kSourceMappingUrlOffset + kPointerSize;
+  static const int kSourceHashOffset = kSourceMappingUrlOffset + kPointerSize;
+  static const int kSize = kSourceHashOffset + kPointerSize;
 
  private:
   int GetLineNumberWithArray(int code_pos);
@@ -163,7 +163,9 @@ void RuntimeProfiler::AttemptOnStackReplacement(JSFunction* function,
 void RuntimeProfiler::OptimizeNow() {
   HandleScope scope(isolate_);
 
-  if (isolate_->DebuggerHasBreakPoints()) return;
+  if (!FLAG_aotc_runtime_profiler || isolate_->DebuggerHasBreakPoints()) {
+    return;
+  }
 
   DisallowHeapAllocation no_gc;
 
@@ -6,6 +6,7 @@
 
 #include "src/arguments.h"
 #include "src/bootstrapper.h"
+#include "src/compiler.h"
 #include "src/debug.h"
 #include "src/runtime/runtime-utils.h"
 
@@ -284,18 +285,9 @@ RUNTIME_FUNCTION(Runtime_AddJSFunctionForStartPosition) {
   DCHECK(args.length() == 1);
   HandleScope scope(isolate);
   CONVERT_ARG_HANDLE_CHECKED(JSFunction, jsf, 0);
-  auto result = isolate->heap()->undefined_value();
-
-  if (!jsf->context()->IsNativeContext()) {
-    return result;
-  }
-
-  auto globalized_jsf = Handle<JSFunction>::cast(
-      isolate->global_handles()->Create(*jsf));
-  int start_position = jsf->shared()->start_position();
-  isolate->AddJSFunctionForStartPosition(start_position, globalized_jsf);
-
-  return result;
+  isolate->AddJSFunctionForStartPosition(jsf);
+  Compiler::PrewarmSavedOptimizedCode(jsf);
+  return isolate->heap()->undefined_value();
 }
 }
 }  // namespace v8::internal
@@ -6,6 +6,7 @@
 
 #include "src/accessors.h"
 #include "src/arguments.h"
+#include "src/compiler.h"
 #include "src/frames-inl.h"
 #include "src/runtime/runtime-utils.h"
 #include "src/scopeinfo.h"
@@ -85,6 +86,9 @@ RUNTIME_FUNCTION(Runtime_DeclareGlobals) {
   CONVERT_ARG_HANDLE_CHECKED(FixedArray, pairs, 1);
   CONVERT_SMI_ARG_CHECKED(flags, 2);
 
+  // The script whose functions are declared, if it declares any.
+  Handle<Object> script = isolate->factory()->undefined_value();
+
   // Traverse the name/value pairs and set the properties.
   int length = pairs->length();
   for (int i = 0; i < length; i += 2) {
@@ -105,6 +109,7 @@ RUNTIME_FUNCTION(Runtime_DeclareGlobals) {
       // Copy the function and update its context. Use it as value.
       Handle<SharedFunctionInfo> shared =
           Handle<SharedFunctionInfo>::cast(initial_value);
+      script = handle(shared->script(), isolate);
       Handle<JSFunction> function =
           isolate->factory()->NewFunctionFromSharedFunctionInfo(shared, context,
                                                                 TENURED);
@@ -128,6 +133,15 @@ RUNTIME_FUNCTION(Runtime_DeclareGlobals) {
     if (isolate->has_pending_exception()) return result;
   }
 
+  // The top-level functions of the script exist now, so saved code for them
+  // can be installed before the script starts running.
+  if (Compiler::IsLoadingCode() && FLAG_saveload_prewarm &&
+      !DeclareGlobalsNativeFlag::decode(flags) &&
+      !DeclareGlobalsEvalFlag::decode(flags) && script->IsScript()) {
+    Compiler::PrewarmSavedOptimizedCode(isolate,
+                                        Handle<Script>::cast(script));
+  }
+
   return isolate->heap()->undefined_value();
 }
 
@@ -496,8 +510,11 @@ RUNTIME_FUNCTION(Runtime_NewClosureFromStubFailure) {
   CONVERT_ARG_HANDLE_CHECKED(SharedFunctionInfo, shared, 0);
   Handle<Context> context(isolate->context());
   PretenureFlag pretenure_flag = NOT_TENURED;
-  return *isolate->factory()->NewFunctionFromSharedFunctionInfo(shared, context,
-                                                                pretenure_flag);
+  Handle<JSFunction> function =
+      isolate->factory()->NewFunctionFromSharedFunctionInfo(shared, context,
+                                                            pretenure_flag);
+  Compiler::PrewarmSavedOptimizedCode(function);
+  return *function;
 }
 
 
@@ -511,8 +528,11 @@ RUNTIME_FUNCTION(Runtime_NewClosure) {
   // The caller ensures that we pretenure closures that are assigned
   // directly to properties.
   PretenureFlag pretenure_flag = pretenure ? TENURED : NOT_TENURED;
-  return *isolate->factory()->NewFunctionFromSharedFunctionInfo(shared, context,
-                                                                pretenure_flag);
+  Handle<JSFunction> function =
+      isolate->factory()->NewFunctionFromSharedFunctionInfo(shared, context,
+                                                            pretenure_flag);
+  Compiler::PrewarmSavedOptimizedCode(function);
+  return *function;
 }
 
 static Object* FindNameClash(Handle<ScopeInfo> scope_info,
@@ -0,0 +1,95 @@
+#include "src/saved-deopt-profile.h"
+
+#include "src/flags.h"
+#include "src/objects-inl.h"
+
+namespace v8 {
+namespace internal {
+
+SavedDeoptProfile::SavedDeoptProfile(const char* filename)
+    : filename_(filename) {
+  FILE* file = base::OS::FOpen(filename, "r");
+  if (!file) {
+    return;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), file)) {
+    // Lines of profiles written without the inner function are skipped.
+    int source_hash, start_position, inner_source_hash, inner_start_position;
+    int ast_id, type, count;
+    char rest;
+    if (sscanf(line, "%d %d %d %d %d %d %d %c", &source_hash,
+               &start_position, &inner_source_hash, &inner_start_position,
+               &ast_id, &type, &count, &rest) != 7 ||
+        type < Deoptimizer::EAGER || type > Deoptimizer::SOFT || count <= 0) {
+      continue;
+    }
+    Site site = { CodeBlockDatabase::Key(source_hash, start_position),
+                  CodeBlockDatabase::Key(inner_source_hash,
+                                         inner_start_position),
+                  ast_id, type };
+    counts_[site] += count;
+  }
+  fclose(file);
+
+  if (FLAG_trace_saveload) {
+    PrintF("[deopt profile \"%s\" read, %d sites]\n", filename,
+           static_cast<int>(counts_.size()));
+  }
+}
+
+
+void SavedDeoptProfile::Write() const {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  FILE* file = base::OS::FOpen(filename_, "w");
+  if (!file) {
+    PrintF("[deopt profile could not be saved to \"%s\"]\n", filename_);
+    return;
+  }
+  for (const auto& site_and_count: counts_) {
+    const Site& site = site_and_count.first;
+    fprintf(file, "%d %d %d %d %d %d %d\n", site.key.source_hash,
+            site.key.start_position, site.inner.source_hash,
+            site.inner.start_position, site.ast_id, site.type,
+            site_and_count.second);
+  }
+  fclose(file);
+
+  if (FLAG_trace_saveload) {
+    PrintF("[deopt profile saved to \"%s\", %d sites]\n", filename_,
+           static_cast<int>(counts_.size()));
+  }
+}
+
+
+// static
+CodeBlockDatabase::Key SavedDeoptProfile::KeyFor(SharedFunctionInfo* shared) {
+  // Functions without a script have no source hash.
+  if (!shared->script()->IsScript()) {
+    return CodeBlockDatabase::Key(0, shared->start_position());
+  }
+  return CodeBlockDatabase::Key(Script::cast(shared->script())->GetSourceHash(),
+                                shared->start_position());
+}
+
+
+void SavedDeoptProfile::Record(SharedFunctionInfo* shared,
+                               SharedFunctionInfo* inner, BailoutId ast_id,
+                               Deoptimizer::BailoutType type) {
+  DCHECK(type != Deoptimizer::DEBUGGER);
+  Site site = { KeyFor(shared), KeyFor(inner), ast_id.ToInt(), type };
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  counts_[site]++;
+}
+
+
+bool SavedDeoptProfile::DeoptimizedAt(SharedFunctionInfo* shared,
+                                      SharedFunctionInfo* inner,
+                                      BailoutId ast_id,
+                                      Deoptimizer::BailoutType type) const {
+  Site site = { KeyFor(shared), KeyFor(inner), ast_id.ToInt(), type };
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  return counts_.count(site) != 0;
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,76 @@
+#ifndef V8_SAVED_DEOPT_PROFILE_H_
+#define V8_SAVED_DEOPT_PROFILE_H_
+
+#include <map>
+
+#include "src/base/platform/mutex.h"
+#include "src/code-block-database.h"
+#include "src/deoptimizer.h"
+#include "src/utils.h"
+
+namespace v8 {
+namespace internal {
+
+// Deoptimizations of loaded code, recorded by runs that load a code block
+// database and read back by runs that save one (see
+// --saveload-deopt-profile).  A saving run can then generate code that
+// doesn't deoptimize where the loaded code did, so that the saved code
+// converges to being deopt-free over several training runs.
+//
+// The profile is a text file with a line per deoptimization site:
+//
+//   source_hash start_position inner_source_hash inner_start_position
+//   ast_id bailout_type count
+//
+// where the first key is that of the saved code block, the second that of
+// the function the site is in, which differs for sites in inlined
+// functions, and ast_id is the bailout id the deoptimizer reported, which
+// is only unique within that function.  Runs that load code add their
+// deoptimizations to the counts.
+class SavedDeoptProfile {
+ public:
+  // Reads |filename| if it exists.
+  explicit SavedDeoptProfile(const char* filename);
+
+  void Write() const;
+
+  // Called by the deoptimizer for code loaded from the database.  |inner|
+  // is the function of the innermost frame, which |ast_id| belongs to.
+  void Record(SharedFunctionInfo* shared, SharedFunctionInfo* inner,
+              BailoutId ast_id, Deoptimizer::BailoutType type);
+
+  // Whether the code of |shared| deoptimized at |ast_id| of |inner|, which
+  // is |shared| itself or a function inlined into it, in the way given by
+  // |type|.
+  bool DeoptimizedAt(SharedFunctionInfo* shared, SharedFunctionInfo* inner,
+                     BailoutId ast_id, Deoptimizer::BailoutType type) const;
+
+ private:
+  struct Site {
+    CodeBlockDatabase::Key key;
+    CodeBlockDatabase::Key inner;
+    int ast_id;
+    int type;
+
+    bool operator<(const Site& other) const {
+      if (!(key == other.key)) return key < other.key;
+      if (!(inner == other.inner)) return inner < other.inner;
+      if (ast_id != other.ast_id) return ast_id < other.ast_id;
+      return type < other.type;
+    }
+  };
+
+  // The key of the code block saved for |shared|.
+  static CodeBlockDatabase::Key KeyFor(SharedFunctionInfo* shared);
+
+  const char* filename_;
+  // Deoptimizations may be recorded by several isolates at once.
+  mutable base::Mutex mutex_;
+  std::map<Site, int> counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(SavedDeoptProfile);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_SAVED_DEOPT_PROFILE_H_
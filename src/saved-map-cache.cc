@@ -0,0 +1,113 @@
+#include "src/saved-map-cache.h"
+
+#include "src/global-handles.h"
+#include "src/isolate.h"
+#include "src/objects-inl.h"
+
+namespace v8 {
+namespace internal {
+
+// static
+uint32_t SavedMapCache::Hash(Vector<const char> saved_map) {
+  uint32_t running_hash = 0;
+  for (char c: saved_map) {
+    running_hash = StringHasher::AddCharacterCore(running_hash,
+                                                  static_cast<uint8_t>(c));
+  }
+  return StringHasher::GetHashCore(running_hash);
+}
+
+
+bool SavedMapCache::Node::Match(void* key1, void* key2) {
+  Node* node1 = static_cast<Node*>(key1);
+  Node* node2 = static_cast<Node*>(key2);
+  return node1->pool_id == node2->pool_id &&
+         node1->hash == node2->hash &&
+         node1->saved_map == node2->saved_map;
+}
+
+
+void SavedMapCache::Add(int pool_id, uint32_t hash,
+                        Vector<const char> saved_map, Handle<Map> map) {
+  Node key = { this, pool_id, hash, saved_map, NULL };
+  HashMap::Entry* entry = HashMap::Lookup(&key, hash, true);
+  Node* node = static_cast<Node*>(entry->value);
+  if (node != NULL) {
+    if (*node->location == *map) {
+      return;
+    }
+    GlobalHandles::Destroy(node->location);
+  } else {
+    Vector<char> copy = Vector<char>::New(saved_map.length());
+    CopyChars(copy.start(), saved_map.start(), saved_map.length());
+    node = new Node(key);
+    node->saved_map = Vector<const char>(copy.start(), copy.length());
+    entry->key = node;
+    entry->value = node;
+  }
+
+  node->location = isolate_->global_handles()->Create(*map).location();
+  GlobalHandles::MakeWeak(node->location,
+                          node,
+                          SavedMapCache::HandleWeakMap);
+}
+
+
+Handle<Map> SavedMapCache::Lookup(int pool_id, uint32_t hash,
+                                  Vector<const char> saved_map) {
+  Node key = { this, pool_id, hash, saved_map, NULL };
+  HashMap::Entry* entry = HashMap::Lookup(&key, hash, false);
+  if (entry == NULL) {
+    return Handle<Map>::null();
+  }
+  Node* node = static_cast<Node*>(entry->value);
+  Map* map = Map::cast(*node->location);
+  if (map->is_deprecated() || !BelongsToCurrentContext(map)) {
+    GlobalHandles::Destroy(node->location);
+    Remove(node);
+    return Handle<Map>::null();
+  }
+  return Handle<Map>(map, isolate_);
+}
+
+
+bool SavedMapCache::BelongsToCurrentContext(Map* map) {
+  Object* constructor = map->constructor();
+  if (!constructor->IsJSFunction()) {
+    return true;
+  }
+  return JSFunction::cast(constructor)->context()->native_context() ==
+         *isolate_->native_context();
+}
+
+
+void SavedMapCache::Remove(Node* node) {
+  void* removed = HashMap::Remove(node, node->hash);
+  DCHECK(removed == node);
+  USE(removed);
+  node->saved_map.Dispose();
+  delete node;
+}
+
+
+void SavedMapCache::Clear() {
+  for (HashMap::Entry* entry = Start(); entry != NULL; entry = Next(entry)) {
+    Node* node = static_cast<Node*>(entry->value);
+    DCHECK((*node->location)->IsMap());
+    GlobalHandles::ClearWeakness(node->location);
+    GlobalHandles::Destroy(node->location);
+    node->saved_map.Dispose();
+    delete node;
+  }
+  HashMap::Clear();
+}
+
+
+void SavedMapCache::HandleWeakMap(
+    const v8::WeakCallbackData<v8::Value, void>& data) {
+  Node* node = static_cast<Node*>(data.GetParameter());
+  GlobalHandles::Destroy(node->location);
+  node->cache->Remove(node);
+}
+
+} }  // namespace v8::internal
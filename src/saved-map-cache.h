@@ -0,0 +1,66 @@
+#ifndef V8_SAVED_MAP_CACHE_H_
+#define V8_SAVED_MAP_CACHE_H_
+
+#include "src/handles.h"
+#include "src/hashmap.h"
+#include "src/vector.h"
+
+namespace v8 {
+namespace internal {
+
+// Maps loaded from saved code, keyed by their saved form: the bytes that
+// LChunkSaverBase::SaveMap produced, together with the constant pool these
+// bytes refer to.  Chunks that use the same shape can then skip replaying
+// the transition chain and deduplicating the result.  The maps are held
+// through weak global handles, and a deprecated map is dropped on lookup,
+// since the transition tree it was found in has changed.  Maps of another
+// native context are not returned, as their prototypes differ.
+class SavedMapCache : private HashMap {
+ public:
+  explicit SavedMapCache(Isolate* isolate)
+      : HashMap(Node::Match),
+        isolate_(isolate) {}
+  ~SavedMapCache() { Clear(); }
+
+  // The hash saved along with a map.
+  static uint32_t Hash(Vector<const char> saved_map);
+
+  // |saved_map| is copied.
+  void Add(int pool_id, uint32_t hash, Vector<const char> saved_map,
+           Handle<Map> map);
+
+  // Returns a null handle if there is no live, up-to-date map saved this way.
+  Handle<Map> Lookup(int pool_id, uint32_t hash, Vector<const char> saved_map);
+
+ private:
+  // Both the key and the value of a hash map entry.  Also passed to the weak
+  // handle callback.
+  struct Node {
+    SavedMapCache* cache;
+    int pool_id;
+    uint32_t hash;
+    Vector<const char> saved_map;
+    Object** location;
+
+    static bool Match(void* key1, void* key2);
+  };
+
+  // Whether |map| was created in the native context we are loading into.
+  bool BelongsToCurrentContext(Map* map);
+
+  void Remove(Node* node);
+
+  // Clear the cache releasing all the weak handles.
+  void Clear();
+
+  // Weak handle callback for maps in the cache.
+  static void HandleWeakMap(const v8::WeakCallbackData<v8::Value, void>& data);
+
+  Isolate* isolate_;
+
+  DISALLOW_COPY_AND_ASSIGN(SavedMapCache);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_SAVED_MAP_CACHE_H_
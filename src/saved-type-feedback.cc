@@ -0,0 +1,244 @@
+#include "src/saved-type-feedback.h"
+
+#include <limits>
+
+#include "src/code-stubs.h"
+#include "src/compiler.h"
+#include "src/flags.h"
+#include "src/ic/ic-inl.h"
+#include "src/objects-inl.h"
+
+namespace v8 {
+namespace internal {
+
+SavedTypeFeedback::SavedTypeFeedback(const char* filename) {
+  if (!filename) {
+    return;
+  }
+  FILE* file = base::OS::FOpen(filename, "r");
+  if (!file) {
+    return;
+  }
+  int source_hash, start_position, ast_id, kind;
+  uint32_t state;
+  while (fscanf(file, "%d %d %d %d %u", &source_hash, &start_position,
+                &ast_id, &kind, &state) == 5) {
+    if (kind != Code::BINARY_OP_IC && kind != Code::COMPARE_IC &&
+        kind != Code::TO_BOOLEAN_IC) {
+      continue;
+    }
+    Site site = { CodeBlockDatabase::Key(source_hash, start_position),
+                  ast_id, kind };
+    states_[site] = state;
+  }
+  fclose(file);
+
+  if (FLAG_trace_saveload) {
+    PrintF("[type feedback \"%s\" read, %d ICs]\n", filename,
+           static_cast<int>(states_.size()));
+  }
+}
+
+
+void SavedTypeFeedback::Write(const char* filename) const {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  FILE* file = base::OS::FOpen(filename, "w");
+  if (!file) {
+    PrintF("[type feedback could not be saved to \"%s\"]\n", filename);
+    return;
+  }
+  for (const auto& site_and_state: states_) {
+    const Site& site = site_and_state.first;
+    fprintf(file, "%d %d %d %d %u\n", site.key.source_hash,
+            site.key.start_position, site.ast_id, site.kind,
+            site_and_state.second);
+  }
+  fclose(file);
+
+  if (FLAG_trace_saveload) {
+    PrintF("[type feedback saved to \"%s\", %d ICs]\n", filename,
+           static_cast<int>(states_.size()));
+  }
+}
+
+
+// static
+bool SavedTypeFeedback::GetState(Code* target, uint32_t* state) {
+  switch (target->kind()) {
+    case Code::BINARY_OP_IC:
+    case Code::TO_BOOLEAN_IC:
+      if (target->ic_state() == UNINITIALIZED) {
+        return false;
+      }
+      *state = static_cast<uint32_t>(target->extra_ic_state());
+      return true;
+    case Code::COMPARE_IC: {
+      CompareICStub stub(target->stub_key(), target->GetIsolate());
+      // Known objects are compared by map.
+      if (stub.state() == CompareICState::UNINITIALIZED ||
+          stub.state() == CompareICState::KNOWN_OBJECT) {
+        return false;
+      }
+      *state = target->stub_key();
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+
+// static
+Handle<Code> SavedTypeFeedback::GetTarget(Isolate* isolate, Code* target,
+                                          uint32_t state,
+                                          bool* enable_inlined_smi_code) {
+  switch (target->kind()) {
+    case Code::BINARY_OP_IC: {
+      BinaryOpICState old_state(isolate, target->extra_ic_state());
+      BinaryOpICState new_state(isolate, static_cast<ExtraICState>(state));
+      if (new_state.op() != old_state.op() ||
+          new_state.mode() != old_state.mode()) {
+        return Handle<Code>::null();
+      }
+      *enable_inlined_smi_code =
+          !old_state.UseInlinedSmiCode() && new_state.UseInlinedSmiCode();
+      // Strings are added without an allocation site, which the IC creates
+      // when it next misses.
+      return BinaryOpICStub(isolate, new_state).GetCode();
+    }
+    case Code::COMPARE_IC: {
+      if (CodeStub::MajorKeyFromKey(state) != CodeStub::CompareIC) {
+        return Handle<Code>::null();
+      }
+      CompareICStub old_stub(target->stub_key(), isolate);
+      CompareICStub new_stub(state, isolate);
+      if (new_stub.op() != old_stub.op() ||
+          new_stub.state() == CompareICState::KNOWN_OBJECT) {
+        return Handle<Code>::null();
+      }
+      *enable_inlined_smi_code =
+          old_stub.state() == CompareICState::UNINITIALIZED;
+      return new_stub.GetCode();
+    }
+    case Code::TO_BOOLEAN_IC:
+      if (state > std::numeric_limits<byte>::max()) {
+        return Handle<Code>::null();
+      }
+      *enable_inlined_smi_code = false;
+      return ToBooleanStub(isolate, static_cast<ExtraICState>(state))
+          .GetCode();
+    default:
+      return Handle<Code>::null();
+  }
+}
+
+
+void SavedTypeFeedback::Record(Isolate* isolate) {
+  int recorded = 0;
+  HeapIterator iterator(isolate->heap());
+  DisallowHeapAllocation no_allocation;
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  for (HeapObject* object = iterator.next(); object != NULL;
+       object = iterator.next()) {
+    if (!object->IsSharedFunctionInfo()) {
+      continue;
+    }
+    SharedFunctionInfo* shared = SharedFunctionInfo::cast(object);
+    Object* script = shared->script();
+    if (!script->IsScript() ||
+        Script::cast(script)->type()->value() != Script::TYPE_NORMAL ||
+        shared->code()->kind() != Code::FUNCTION) {
+      continue;
+    }
+
+    CodeBlockDatabase::Key key(Script::cast(script)->GetSourceHash(),
+                               shared->start_position());
+    int mask = RelocInfo::ModeMask(RelocInfo::CODE_TARGET_WITH_ID);
+    for (RelocIterator it(shared->code(), mask); !it.done(); it.next()) {
+      RelocInfo* info = it.rinfo();
+      Code* target = Code::GetCodeFromTargetAddress(info->target_address());
+      uint32_t state;
+      if (GetState(target, &state)) {
+        Site site = { key, static_cast<int>(info->data()), target->kind() };
+        states_[site] = state;
+        recorded++;
+      }
+    }
+  }
+
+  if (FLAG_trace_saveload) {
+    PrintF("[type feedback of %d ICs recorded]\n", recorded);
+  }
+}
+
+
+void SavedTypeFeedback::Replay(CompilationInfo* info) {
+  Handle<Script> script = info->script();
+  if (script.is_null() || script->IsUndefined() ||
+      script->type()->value() != Script::TYPE_NORMAL) {
+    return;
+  }
+
+  struct Patch {
+    int pc_offset;
+    Handle<Code> target;
+    uint32_t state;
+  };
+
+  Isolate* isolate = info->isolate();
+  HandleScope scope(isolate);
+  Handle<Code> code = info->code();
+  CodeBlockDatabase::Key key(script->GetSourceHash(),
+                             info->function()->start_position());
+  List<Patch> patches;
+  {
+    // The stubs are created once the code is no longer iterated.
+    DisallowHeapAllocation no_allocation;
+    base::LockGuard<base::Mutex> lock_guard(&mutex_);
+    Site first = { key, std::numeric_limits<int>::min(), 0 };
+    auto lower_bound = states_.lower_bound(first);
+    if (lower_bound == states_.end() || !(lower_bound->first.key == key)) {
+      return;
+    }
+
+    int mask = RelocInfo::ModeMask(RelocInfo::CODE_TARGET_WITH_ID);
+    for (RelocIterator it(*code, mask); !it.done(); it.next()) {
+      RelocInfo* reloc_info = it.rinfo();
+      Code* target =
+          Code::GetCodeFromTargetAddress(reloc_info->target_address());
+      Site site = { key, static_cast<int>(reloc_info->data()),
+                    target->kind() };
+      auto found = states_.find(site);
+      if (found != states_.end()) {
+        Patch patch = {
+          static_cast<int>(reloc_info->pc() - code->instruction_start()),
+          Handle<Code>(target), found->second };
+        patches.Add(patch);
+      }
+    }
+  }
+
+  int replayed = 0;
+  for (int i = 0; i < patches.length(); ++i) {
+    const Patch& patch = patches[i];
+    bool enable_inlined_smi_code = false;
+    Handle<Code> target = GetTarget(isolate, *patch.target, patch.state,
+                                    &enable_inlined_smi_code);
+    if (target.is_null()) {
+      continue;
+    }
+    Address address = code->instruction_start() + patch.pc_offset;
+    IC::SetTargetAtAddress(address, *target, code->constant_pool());
+    if (enable_inlined_smi_code) {
+      PatchInlinedSmiCode(address, ENABLE_INLINED_SMI_CHECK);
+    }
+    replayed++;
+  }
+
+  if (FLAG_trace_saveload && replayed > 0) {
+    PrintF("[type feedback of %d ICs replayed for %d]\n", replayed,
+           key.start_position);
+  }
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,81 @@
+#ifndef V8_SAVED_TYPE_FEEDBACK_H_
+#define V8_SAVED_TYPE_FEEDBACK_H_
+
+#include <map>
+
+#include "src/base/platform/mutex.h"
+#include "src/code-block-database.h"
+#include "src/utils.h"
+
+namespace v8 {
+namespace internal {
+
+class CompilationInfo;
+
+// States of the inline caches of full code, recorded when an isolate is torn
+// down (see --saveload-record-feedback) and replayed into the full code
+// generated by a later run (see --saveload-replay-feedback), so that
+// Crankshaft sees the types of a warmed-up run without running the workload.
+// This lets aotc compile functions that its warmup scripts don't reach, and
+// lets the JIT optimize type-stable functions as soon as they get hot.
+//
+// Only the ICs whose state is self-contained are recorded: binary
+// operations, comparisons that don't depend on a map, and conversions to
+// boolean.  Property ICs and the feedback vector refer to maps and closures
+// of the recording isolate, so they still need a warmup.
+//
+// The file is a text file with a line per IC:
+//
+//   source_hash start_position ast_id kind state
+//
+// where the key is that of the function's code block, ast_id is the
+// TypeFeedbackId of the IC, kind is its Code::Kind and state is the extra
+// IC state, or the stub key for comparisons.  It is only meaningful to the
+// V8 version that recorded it; ICs whose operation doesn't match are left
+// alone.
+class SavedTypeFeedback {
+ public:
+  // Reads |filename| if it is given and exists.
+  explicit SavedTypeFeedback(const char* filename);
+
+  void Write(const char* filename) const;
+
+  // Adds the IC states of the full code of every function of |isolate|.
+  // Later records of an IC replace earlier ones.
+  void Record(Isolate* isolate);
+
+  // Patches the ICs of the full code just generated for |info|.
+  void Replay(CompilationInfo* info);
+
+ private:
+  struct Site {
+    CodeBlockDatabase::Key key;
+    int ast_id;
+    int kind;
+
+    bool operator<(const Site& other) const {
+      if (!(key == other.key)) return key < other.key;
+      if (ast_id != other.ast_id) return ast_id < other.ast_id;
+      return kind < other.kind;
+    }
+  };
+
+  // Whether the state of |target| is worth recording, and if so the state.
+  static bool GetState(Code* target, uint32_t* state);
+  // Returns a null handle if |state| doesn't fit the IC |target| is the
+  // uninitialized stub of.  |enable_inlined_smi_code| is set if the inlined
+  // smi check at the call site must be turned on.
+  static Handle<Code> GetTarget(Isolate* isolate, Code* target,
+                                uint32_t state,
+                                bool* enable_inlined_smi_code);
+
+  // Functions may be recorded and compiled by several isolates at once.
+  mutable base::Mutex mutex_;
+  std::map<Site, uint32_t> states_;
+
+  DISALLOW_COPY_AND_ASSIGN(SavedTypeFeedback);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_SAVED_TYPE_FEEDBACK_H_
@@ -0,0 +1,131 @@
+#include "src/saveload-report.h"
+
+#include "src/compiler.h"
+#include "src/flags.h"
+#include "src/objects-inl.h"
+
+namespace v8 {
+namespace internal {
+
+void SaveloadReport::Write() const {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  FILE* file = base::OS::FOpen(filename_, "w");
+  if (!file) {
+    PrintF("[saveload report could not be written to \"%s\"]\n", filename_);
+    return;
+  }
+  fprintf(file, "name\tsource_hash\tstart_position\tosr_ast_id\tsize\tsaved\t"
+                "loaded\tfailed\tload_us\tcodegen_us\tdeopts\tmismatches\t"
+                "detached_maps\treason\n");
+  for (const auto& key_and_row: rows_) {
+    const CodeBlockDatabase::Key& key = key_and_row.first;
+    const Row& row = key_and_row.second;
+    fprintf(file,
+            "%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%.0f\t%.0f\t%d\t%d\t%d\t%s\n",
+            row.name.c_str(), key.source_hash, key.start_position,
+            key.osr_ast_id, row.size, row.saved, row.loaded, row.failed,
+            row.load_us, row.codegen_us, row.deopts, row.mismatches,
+            row.detached_maps, row.reason ? row.reason : "-");
+  }
+  fclose(file);
+
+  if (FLAG_trace_saveload) {
+    PrintF("[saveload report written to \"%s\", %d code blocks]\n",
+           filename_, static_cast<int>(rows_.size()));
+  }
+}
+
+
+SaveloadReport::Row* SaveloadReport::GetRow(
+    const CodeBlockDatabase::Key& key, SharedFunctionInfo* shared) {
+  auto result = rows_.insert(std::make_pair(key, Row()));
+  Row* row = &result.first->second;
+  if (result.second) {
+    SmartArrayPointer<char> name = shared->DebugName()->ToCString();
+    row->name = name[0] != '\0' ? name.get() : "<anonymous>";
+    row->size = 0;
+    row->saved = 0;
+    row->loaded = 0;
+    row->failed = 0;
+    row->load_us = 0;
+    row->codegen_us = 0;
+    row->deopts = 0;
+    row->mismatches = 0;
+    row->detached_maps = 0;
+    row->reason = nullptr;
+  }
+  return row;
+}
+
+
+SaveloadReport::Row* SaveloadReport::GetRow(CompilationInfo* info) {
+  SharedFunctionInfo* shared = *info->shared_info();
+  CodeBlockDatabase::Key key(Script::cast(shared->script())->GetSourceHash(),
+                             shared->start_position(),
+                             info->osr_ast_id().ToInt());
+  return GetRow(key, shared);
+}
+
+
+void SaveloadReport::RecordSaved(CompilationInfo* info, int size) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  Row* row = GetRow(info);
+  row->size = size;
+  row->saved++;
+}
+
+
+void SaveloadReport::RecordNotSaved(CompilationInfo* info,
+                                    const char* reason) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  GetRow(info)->reason = reason;
+}
+
+
+void SaveloadReport::RecordLoaded(CompilationInfo* info, int size,
+                                  base::TimeDelta load_time,
+                                  base::TimeDelta codegen_time) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  Row* row = GetRow(info);
+  row->size = size;
+  row->loaded++;
+  row->load_us += load_time.InMicroseconds();
+  row->codegen_us += codegen_time.InMicroseconds();
+}
+
+
+void SaveloadReport::RecordLoadFailed(CompilationInfo* info, int size,
+                                      base::TimeDelta load_time,
+                                      const char* reason) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  Row* row = GetRow(info);
+  row->size = size;
+  row->failed++;
+  row->load_us += load_time.InMicroseconds();
+  row->reason = reason;
+}
+
+
+void SaveloadReport::RecordDeopt(SharedFunctionInfo* shared) {
+  CodeBlockDatabase::Key key(Script::cast(shared->script())->GetSourceHash(),
+                             shared->start_position());
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  GetRow(key, shared)->deopts++;
+}
+
+
+void SaveloadReport::RecordMismatch(CompilationInfo* info,
+                                    const char* reason) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  Row* row = GetRow(info);
+  row->mismatches++;
+  row->reason = reason;
+}
+
+
+void SaveloadReport::RecordDetachedMap(CompilationInfo* info) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  GetRow(info)->detached_maps++;
+}
+
+} }  // namespace v8::internal
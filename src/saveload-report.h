@@ -0,0 +1,84 @@
+#ifndef V8_SAVELOAD_REPORT_H_
+#define V8_SAVELOAD_REPORT_H_
+
+#include <map>
+#include <string>
+
+#include "src/base/platform/mutex.h"
+#include "src/base/platform/time.h"
+#include "src/code-block-database.h"
+#include "src/utils.h"
+
+namespace v8 {
+namespace internal {
+
+class CompilationInfo;
+class SharedFunctionInfo;
+
+// What saving and loading optimized code did for each function, written to
+// --saveload-report when V8 is torn down, so that the functions that fail
+// to load, deoptimize or take long to load can be found.  The totals are
+// also kept in the V8.Saveload* StatsCounters.
+//
+// The report is a tab-separated text file with a header line and a line per
+// code block, i.e. per function and OSR entry, in key order:
+//
+//   name source_hash start_position osr_ast_id size saved loaded failed
+//   load_us codegen_us deopts mismatches detached_maps reason
+//
+// where size is that of the chunk last saved or loaded, saved, loaded and
+// failed count the attempts of all isolates, the times are totals, deopts
+// counts the deoptimizations of loaded code, mismatches the loaded chunks
+// that differed from a fresh one (see --saveload-validate), detached_maps
+// the maps that were loaded as detached copies (their transition had been
+// overwritten when they were saved) and matched no existing map, and reason
+// is why the chunk was last not saved, failed to load or differed, or "-".
+class SaveloadReport {
+ public:
+  explicit SaveloadReport(const char* filename) : filename_(filename) {}
+
+  void Write() const;
+
+  void RecordSaved(CompilationInfo* info, int size);
+  void RecordNotSaved(CompilationInfo* info, const char* reason);
+  // |load_time| is the time spent deserializing the chunk, |codegen_time|
+  // the time spent generating code from it.
+  void RecordLoaded(CompilationInfo* info, int size, base::TimeDelta load_time,
+                    base::TimeDelta codegen_time);
+  void RecordLoadFailed(CompilationInfo* info, int size,
+                        base::TimeDelta load_time, const char* reason);
+  void RecordDeopt(SharedFunctionInfo* shared);
+  void RecordMismatch(CompilationInfo* info, const char* reason);
+  void RecordDetachedMap(CompilationInfo* info);
+
+ private:
+  struct Row {
+    std::string name;
+    int size;
+    int saved;
+    int loaded;
+    int failed;
+    double load_us;
+    double codegen_us;
+    int deopts;
+    int mismatches;
+    int detached_maps;
+    const char* reason;  // A string literal or bailout reason.
+  };
+
+  // Returns the row of the code block, adding it if needed.  The mutex must
+  // be held.
+  Row* GetRow(const CodeBlockDatabase::Key& key, SharedFunctionInfo* shared);
+  Row* GetRow(CompilationInfo* info);
+
+  const char* filename_;
+  // Code is saved and loaded by several isolates at once, e.g. in aotc.
+  mutable base::Mutex mutex_;
+  std::map<CodeBlockDatabase::Key, Row> rows_;
+
+  DISALLOW_COPY_AND_ASSIGN(SaveloadReport);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_SAVELOAD_REPORT_H_
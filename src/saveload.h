@@ -1,6 +1,8 @@
 #ifndef V8_SAVELOAD_H_
 #define V8_SAVELOAD_H_
 
+#include <type_traits>
+
 #include "src/list.h"
 #include "src/vector.h"
 
@@ -60,6 +62,148 @@ inline bool LoadBool(const char** bytes) {
   return LoadPrimitive<char>(bytes);
 }
 
+
+// Compact encoding.
+//
+// Most integers in saved code (operand indices, ids, lengths, enums) are
+// small, so they are saved as LEB128 varints: seven bits per byte, least
+// significant group first, with the high bit set on all but the last byte.
+// Signed values are zigzag-encoded first, so that small negative values
+// stay short too.  Everything else is saved as it is.
+
+inline void SaveVarint(List<char>& bytes, uint64_t value) {
+  while (value >= 0x80) {
+    bytes.Add(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.Add(static_cast<char>(value));
+}
+
+
+inline uint64_t LoadVarint(const char** bytes) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(*bytes);
+  // Most values fit into a single byte.
+  if (*data < 0x80) {
+    *bytes += 1;
+    return *data;
+  }
+
+  uint64_t value = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    byte = *data++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  *bytes = reinterpret_cast<const char*>(data);
+  return value;
+}
+
+
+inline uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+
+inline int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+
+// The integer type a value is saved as, for types that are saved as varints.
+template<typename T, bool = std::is_enum<T>::value>
+struct CompactIntegerType {
+  typedef T type;
+};
+
+
+template<typename T>
+struct CompactIntegerType<T, true> {
+  typedef typename std::underlying_type<T>::type type;
+};
+
+
+// Single bytes gain nothing from being saved as varints.
+template<typename T,
+         bool = ((std::is_integral<T>::value || std::is_enum<T>::value) &&
+                 sizeof(T) > 1)>
+struct CompactEncoding {
+  static void Save(List<char>& bytes, T value) {
+    SavePrimitive<T>(bytes, value);
+  }
+
+  static T Load(const char** bytes) {
+    return LoadPrimitive<T>(bytes);
+  }
+};
+
+
+template<typename T>
+struct CompactEncoding<T, true> {
+  typedef typename CompactIntegerType<T>::type Integer;
+
+  static void Save(List<char>& bytes, T value) {
+    Integer integer = static_cast<Integer>(value);
+    SaveVarint(bytes, std::is_signed<Integer>::value
+                          ? ZigZagEncode(static_cast<int64_t>(integer))
+                          : static_cast<uint64_t>(integer));
+  }
+
+  static T Load(const char** bytes) {
+    uint64_t value = LoadVarint(bytes);
+    return static_cast<T>(static_cast<Integer>(
+        std::is_signed<Integer>::value ? ZigZagDecode(value) : value));
+  }
+};
+
+
+template<typename T>
+void SaveCompact(List<char>& bytes, T value) {
+  CompactEncoding<T>::Save(bytes, value);
+}
+
+
+template<typename T>
+T LoadCompact(const char** bytes) {
+  return CompactEncoding<T>::Load(bytes);
+}
+
+
+// Like SavePrimitiveArray, but with the length saved as a varint.
+template<typename T>
+void SaveCompactArray(List<char>& bytes, Vector<const T> array) {
+  SaveVarint(bytes, static_cast<uint64_t>(array.length()));
+  SavePrimitiveArray(bytes, array, false);
+}
+
+
+// Returns the array in place, so only byte-sized elements, which need no
+// alignment, can be loaded this way.
+template<typename T>
+Vector<const T> LoadCompactArray(const char** bytes) {
+  static_assert(sizeof(T) == 1, "wider elements may be misaligned");
+  int length = static_cast<int>(LoadVarint(bytes));
+  Vector<const T> array(reinterpret_cast<const T*>(*bytes), length);
+  *bytes += length;
+  return array;
+}
+
+
+// Copies the array out into |array|, as its elements may be misaligned.
+template<typename T>
+void LoadCompactArray(const char** bytes, List<T>* array) {
+  int length = static_cast<int>(LoadVarint(bytes));
+  array->Rewind(0);
+  for (int i = 0; i < length; ++i) {
+    T element;
+    memcpy(&element, *bytes, sizeof(T));
+    array->Add(element);
+    *bytes += sizeof(T);
+  }
+}
+
 } }  // namespace v8::internal
 
 #endif  // V8_SAVELOAD_H_
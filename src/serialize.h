@@ -96,6 +96,8 @@ class ExternalReferenceEncoder {
 
   uint32_t Encode(Address key) const;
 
+  bool IsKnown(Address key) const { return IndexOf(key) >= 0; }
+
   const char* NameOfAddress(Address key) const;
 
  private:
@@ -51,6 +51,12 @@ bool Snapshot::HaveASnapshotToStartFrom() {
 }
 
 
+Vector<const char> Snapshot::code_database() {
+  return Vector<const char>(
+      reinterpret_cast<const char*>(code_database_data_), code_database_size_);
+}
+
+
 Handle<Context> Snapshot::NewContextFromSnapshot(Isolate* isolate) {
   if (context_size_ == 0) {
     return Handle<Context>();
@@ -19,6 +19,8 @@ const byte Snapshot::context_data_[] = { 0 };
 const byte* Snapshot::context_raw_data_ = NULL;
 const int Snapshot::context_size_ = 0;
 const int Snapshot::context_raw_size_ = 0;
+const byte Snapshot::code_database_data_[] = { 0 };
+const int Snapshot::code_database_size_ = 0;
 
 const int Snapshot::new_space_used_ = 0;
 const int Snapshot::pointer_space_used_ = 0;
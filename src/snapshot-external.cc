@@ -37,6 +37,9 @@ struct SnapshotImpl {
   int context_cell_space_used;
   int context_property_cell_space_used;
   int context_lo_space_used;
+
+  const byte* code_database_data;
+  int code_database_size;
 };
 
 
@@ -77,6 +80,16 @@ bool Snapshot::Initialize(Isolate* isolate) {
 }
 
 
+Vector<const char> Snapshot::code_database() {
+  if (!HaveASnapshotToStartFrom()) {
+    return Vector<const char>();
+  }
+  return Vector<const char>(
+      reinterpret_cast<const char*>(snapshot_impl_->code_database_data),
+      snapshot_impl_->code_database_size);
+}
+
+
 Handle<Context> Snapshot::NewContextFromSnapshot(Isolate* isolate) {
   if (!HaveASnapshotToStartFrom())
     return Handle<Context>();
@@ -138,6 +151,15 @@ void SetSnapshotFromFile(StartupData* snapshot_blob) {
   snapshot_impl_->context_property_cell_space_used = source.GetInt();
   snapshot_impl_->context_lo_space_used = source.GetInt();
 
+  // Blobs written before databases were embedded end here.
+  snapshot_impl_->code_database_data = NULL;
+  snapshot_impl_->code_database_size = 0;
+  if (source.HasMore()) {
+    success &= source.GetAlignedBlob(&snapshot_impl_->code_database_data,
+                                     &snapshot_impl_->code_database_size,
+                                     Snapshot::kCodeDatabaseAlignment);
+  }
+
   DCHECK(success);
 }
 
@@ -64,6 +64,17 @@ void SnapshotByteSink::PutBlob(byte* data, int number_of_bytes,
 }
 
 
+void SnapshotByteSink::PutAlignedBlob(byte* data, int number_of_bytes,
+                                      int alignment,
+                                      const char* description) {
+  PutInt(number_of_bytes, description);
+  while (Position() % alignment != 0) {
+    Put(SerializerDeserializer::nop(), "BlobPadding");
+  }
+  PutRaw(data, number_of_bytes, description);
+}
+
+
 bool SnapshotByteSource::AtEOF() {
   if (0u + length_ - position_ > 2 * sizeof(uint32_t)) return false;
   for (int x = position_; x < length_; x++) {
@@ -87,5 +98,23 @@ bool SnapshotByteSource::GetBlob(const byte** data, int* number_of_bytes) {
   }
 }
 
+
+bool SnapshotByteSource::GetAlignedBlob(const byte** data,
+                                        int* number_of_bytes, int alignment) {
+  int size = GetInt();
+  *number_of_bytes = size;
+  Advance(RoundUp(position_, alignment) - position_);
+
+  // Unlike the other blobs, an aligned blob may end the source.
+  if (position_ + size <= length_) {
+    *data = &data_[position_];
+    Advance(size);
+    return true;
+  } else {
+    Advance(length_ - position_);  // proceed until end.
+    return false;
+  }
+}
+
 }  // namespace v8::internal
 }  // namespace v8
@@ -49,6 +49,8 @@ class SnapshotByteSource FINAL {
   }
 
   bool GetBlob(const byte** data, int* number_of_bytes);
+  // Reads a blob written by SnapshotByteSink::PutAlignedBlob.
+  bool GetAlignedBlob(const byte** data, int* number_of_bytes, int alignment);
 
   bool AtEOF();
 
@@ -85,6 +87,10 @@ class SnapshotByteSink {
   void PutInt(uintptr_t integer, const char* description);
   void PutRaw(byte* data, int number_of_bytes, const char* description);
   void PutBlob(byte* data, int number_of_bytes, const char* description);
+  // Pads the blob with nops, so that it starts at a multiple of |alignment|
+  // from the start of the sink.
+  void PutAlignedBlob(byte* data, int number_of_bytes, int alignment,
+                      const char* description);
   int Position() { return data_.length(); }
 
   const List<byte>& data() const { return data_; }
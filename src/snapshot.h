@@ -28,6 +28,15 @@ class Snapshot {
   static void set_raw_data(const byte* raw_data) {
     raw_data_ = raw_data;
   }
+  // The code block database embedded with mksnapshot --embed-code, or an
+  // empty vector.  It lives as long as the process.
+  static Vector<const char> code_database();
+  // The database is aligned to this in the snapshot, so that its tables can
+  // be read in place.  In an external startup blob, the alignment is from
+  // the start of the blob, which the embedder should align as well;
+  // otherwise the database is copied.
+  static const int kCodeDatabaseAlignment = 8;
+
   static const byte* context_data() { return context_data_; }
   static int context_size() { return context_size_; }
   static int context_raw_size() { return context_raw_size_; }
@@ -41,6 +50,8 @@ class Snapshot {
   static const byte* raw_data_;
   static const byte context_data_[];
   static const byte* context_raw_data_;
+  static const byte code_database_data_[];
+  static const int code_database_size_;
   static const int new_space_used_;
   static const int pointer_space_used_;
   static const int data_space_used_;
@@ -22,6 +22,7 @@
 #include "src/runtime-profiler.h"
 #include "src/sampler.h"
 #include "src/serialize.h"
+#include "src/snapshot.h"
 
 
 namespace v8 {
@@ -40,6 +41,15 @@ bool V8::Initialize() {
 
 
 void V8::TearDown() {
+  if (Compiler::IsSavingCode() || Compiler::IsLoadingCode()) {
+    Compiler::FinalizeCodeBlockDatabase();
+  }
+  if (FLAG_saveload_record_feedback || FLAG_saveload_replay_feedback) {
+    Compiler::FinalizeSavedTypeFeedback();
+  }
+  if (FLAG_saveload_report) {
+    Compiler::FinalizeSaveloadReport();
+  }
   Bootstrapper::TearDownExtensions();
   ElementsAccessor::TearDown();
   LOperand::TearDownCaches();
@@ -91,6 +101,21 @@ void V8::InitializeOncePerProcessImpl() {
   SetUpJSCallerSavedCodeData();
   ExternalReference::SetUp();
   Bootstrapper::InitializeOncePerProcess();
+
+  if (FLAG_save_code || FLAG_load_code) {
+    Compiler::InitializeCodeBlockDatabase();
+  }
+  // The database embedded with mksnapshot --embed-code is loaded along with
+  // the --load-code files.
+  if (!Snapshot::code_database().is_empty()) {
+    Compiler::AddSavedCode(Snapshot::code_database(), true);
+  }
+  if (FLAG_saveload_record_feedback || FLAG_saveload_replay_feedback) {
+    Compiler::InitializeSavedTypeFeedback();
+  }
+  if (FLAG_saveload_report) {
+    Compiler::InitializeSaveloadReport();
+  }
 }
 
 
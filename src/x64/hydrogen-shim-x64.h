@@ -79,5 +79,11 @@
   V(HWrapReceiverShim, LWrapReceiver)                           \
   V(HInstanceOfKnownGlobalShim, LInstanceOfKnownGlobal)         \
   V(HTypeofIsAndBranchShim, LTypeofIsAndBranch)                 \
+  V(HAllocateBlockContextShim, LAllocateBlockContext)           \
+  V(HCallStubShim, LCallStub)                                   \
+  V(HSeqStringGetCharShim, LSeqStringGetChar)                   \
+  V(HSeqStringSetCharShim, LSeqStringSetChar)                   \
+  V(HTailCallThroughMegamorphicCacheShim,                       \
+    LTailCallThroughMegamorphicCache)                           \
 
 #endif  // V8_HYDROGEN_SHIM_64_H_
@@ -985,7 +985,7 @@ void LCodeGen::DoParameter(LParameter* instr) {
 void LCodeGen::DoCallStub(LCallStub* instr) {
   DCHECK(ToRegister(instr->context()).is(rsi));
   DCHECK(ToRegister(instr->result()).is(rax));
-  switch (instr->hydrogen()->major_key()) {
+  switch (instr->hydrogen_shim()->major_key()) {
     case CodeStub::RegExpExec: {
       RegExpExecStub stub(isolate());
       CallCode(stub.GetCode(), RelocInfo::CODE_TARGET, instr);
@@ -1800,7 +1800,7 @@ Operand LCodeGen::BuildSeqStringOperand(Register string,
 
 
 void LCodeGen::DoSeqStringGetChar(LSeqStringGetChar* instr) {
-  String::Encoding encoding = instr->hydrogen()->encoding();
+  String::Encoding encoding = instr->hydrogen_shim()->encoding();
   Register result = ToRegister(instr->result());
   Register string = ToRegister(instr->string());
 
@@ -1828,7 +1828,7 @@ void LCodeGen::DoSeqStringGetChar(LSeqStringGetChar* instr) {
 
 
 void LCodeGen::DoSeqStringSetChar(LSeqStringSetChar* instr) {
-  String::Encoding encoding = instr->hydrogen()->encoding();
+  String::Encoding encoding = instr->hydrogen_shim()->encoding();
   Register string = ToRegister(instr->string());
 
   if (FLAG_debug_code) {
@@ -1836,8 +1836,7 @@ void LCodeGen::DoSeqStringSetChar(LSeqStringSetChar* instr) {
     Register index = ToRegister(instr->index());
     static const uint32_t one_byte_seq_type = kSeqStringTag | kOneByteStringTag;
     static const uint32_t two_byte_seq_type = kSeqStringTag | kTwoByteStringTag;
-    int encoding_mask =
-        instr->hydrogen()->encoding() == String::ONE_BYTE_ENCODING
+    int encoding_mask = encoding == String::ONE_BYTE_ENCODING
         ? one_byte_seq_type : two_byte_seq_type;
     __ EmitSeqStringSetCharCheck(string, index, value, encoding_mask);
   }
@@ -3536,9 +3535,9 @@ void LCodeGen::DoTailCallThroughMegamorphicCache(
   bool must_teardown_frame = NeedsEagerFrame();
 
   // The probe will tail call to a handler if found.
-  isolate()->stub_cache()->GenerateProbe(masm(), instr->hydrogen()->flags(),
-                                         must_teardown_frame, receiver, name,
-                                         scratch, no_reg);
+  isolate()->stub_cache()->GenerateProbe(
+      masm(), instr->hydrogen_shim()->flags(), must_teardown_frame, receiver,
+      name, scratch, no_reg);
 
   // Tail call to miss if we ended up here.
   if (must_teardown_frame) __ leave();
@@ -1,5 +1,9 @@
 #include "src/x64/lithium-saveload-x64.h"
+#include "src/code-stubs.h"
+#include "src/deoptimizer.h"
 #include "src/hydrogen-osr.h"
+#include "src/ic/ic-compiler.h"
+#include "src/lithium-codegen.h"
 
 namespace v8 {
 namespace internal {
@@ -30,7 +34,11 @@ void LChunkSaver::Save(const LChunk* chunk) {
   RETURN_ON_FAIL(SaveBasicBlocks(graph->blocks()));
   RETURN_ON_FAIL(SaveConstants(chunk));
   RETURN_ON_FAIL(SaveInstructions(chunk->instructions()));
+  RETURN_ON_FAIL(SaveInlinedFunctions(chunk));
+}
+
 
+void LChunkSaver::SaveInlinedFunctions(const LChunk* chunk) {
   SavePrimitive<int>(chunk->inlined_closures()->length());
   for (const Handle<JSFunction> closure: *chunk->inlined_closures()) {
     SaveSharedFunctionInfo(closure->shared());
@@ -41,11 +49,13 @@ void LChunkSaver::Save(const LChunk* chunk) {
 void LChunkSaver::SaveBasicBlocks(const ZoneList<HBasicBlock*>* blocks) {
   SavePrimitive<int>(blocks->length());
 
+  // Blocks cover consecutive ranges of instructions.
+  int last_instruction_index = -1;
   for (int block_index = 0; block_index < blocks->length(); block_index++) {
     HBasicBlock* bb = blocks->at(block_index);
     if (block_index) {
       BailoutId ast_id = bb->last_environment()->ast_id();
-      SavePrimitive(ast_id);
+      SavePrimitive<int>(ast_id.ToInt());
     }
 
     SavePrimitive<bool>(bb->IsLoopHeader());
@@ -61,8 +71,11 @@ void LChunkSaver::SaveBasicBlocks(const ZoneList<HBasicBlock*>* blocks) {
     SavePrimitive<bool>(bb->is_osr_entry());
     SavePrimitive<bool>(bb->IsOrdered());
 
-    SavePrimitive(bb->first_instruction_index());
-    SavePrimitive(bb->last_instruction_index());
+    SavePrimitive<int>(bb->first_instruction_index() -
+                       last_instruction_index);
+    SavePrimitive<int>(bb->last_instruction_index() -
+                       bb->first_instruction_index());
+    last_instruction_index = bb->last_instruction_index();
   }
 
   Synchronize();
@@ -115,9 +128,11 @@ static BitVector* LiveConstants(const LChunk* chunk, Zone* zone) {
 void LChunkSaver::SaveConstants(const LChunk* chunk) {
   BitVector* live_constants = LiveConstants(chunk, zone());
   SavePrimitive<int>(live_constants->Count());
+  // The ids are increasing.
+  int last_id = 0;
   for (BitVector::Iterator it(live_constants); !it.Done(); it.Advance()) {
     int id = it.Current();
-    SavePrimitive<int>(id);
+    SaveDelta(id, &last_id);
 
     HValue* value = chunk->graph()->LookupValue(id);
     DCHECK(value->IsConstant());
@@ -196,7 +211,7 @@ void LChunkSaver::SaveInstruction(const LInstruction* instruction) {
 
 
 void LChunkSaver::SaveLGap(const LGap* gap) {
-  SavePrimitive<int>(gap->block()->block_id());
+  SaveBlockId(gap->block()->block_id());
 
   for (int i = LGap::FIRST_INNER_POSITION; i <= LGap::LAST_INNER_POSITION; ++i) {
     auto pos = static_cast<LGap::InnerPosition>(i);
@@ -227,7 +242,7 @@ void LChunkSaver::SaveLInstructionGap(const LInstructionGap* gap) {
 
 
 void LChunkSaver::SaveLGoto(const LGoto* gotoo) {
-  SavePrimitive<int>(gotoo->block_id());
+  SaveBlockId(gotoo->block_id());
 }
 
 
@@ -301,6 +316,11 @@ void LChunkSaver::SaveLDrop(const LDrop* drop) {
 }
 
 
+void LChunkSaver::SaveLDateField(const LDateField* date_field) {
+  SavePrimitive<int>(date_field->index()->value());
+}
+
+
 void LChunkSaver::SaveLContext(const LContext*) {}
 void LChunkSaver::SaveLArgumentsElements(const LArgumentsElements*) {}
 void LChunkSaver::SaveLArgumentsLength(const LArgumentsLength*) {}
@@ -414,6 +434,20 @@ void LChunkSaver::SaveLLoadFunctionPrototype(const LLoadFunctionPrototype*) {}
 void LChunkSaver::SaveLToFastProperties(const LToFastProperties*) {}
 void LChunkSaver::SaveLAccessArgumentsAt(const LAccessArgumentsAt*) {}
 void LChunkSaver::SaveLTypeof(const LTypeof*) {}
+void LChunkSaver::SaveLAllocateBlockContext(const LAllocateBlockContext*) {}
+void LChunkSaver::SaveLCallStub(const LCallStub*) {}
+void LChunkSaver::SaveLClampDToUint8(const LClampDToUint8*) {}
+void LChunkSaver::SaveLClampIToUint8(const LClampIToUint8*) {}
+void LChunkSaver::SaveLClampTToUint8(const LClampTToUint8*) {}
+void LChunkSaver::SaveLDebugBreak(const LDebugBreak*) {}
+void LChunkSaver::SaveLGetCachedArrayIndex(const LGetCachedArrayIndex*) {}
+void LChunkSaver::SaveLSeqStringGetChar(const LSeqStringGetChar*) {}
+void LChunkSaver::SaveLSeqStringSetChar(const LSeqStringSetChar*) {}
+void LChunkSaver::SaveLStoreCodeEntry(const LStoreCodeEntry*) {}
+void LChunkSaver::SaveLStoreFrameContext(const LStoreFrameContext*) {}
+void LChunkSaver::SaveLTailCallThroughMegamorphicCache(
+    const LTailCallThroughMegamorphicCache*) {}
+void LChunkSaver::SaveLTrapAllocationMemento(const LTrapAllocationMemento*) {}
 
 
 void LChunkLoader::LoadPlatformChunk(LPlatformChunk* chunk) {
@@ -444,11 +478,17 @@ LChunk* LChunkLoader::Load() {
   RETURN_VALUE_ON_FAIL(nullptr, LoadBasicBlocks());
   RETURN_VALUE_ON_FAIL(nullptr, LoadConstants());
   RETURN_VALUE_ON_FAIL(nullptr, LoadInstructions());
+  RETURN_VALUE_ON_FAIL(nullptr, LoadInlinedFunctions());
+
+  return chunk();
+}
+
 
+void LChunkLoader::LoadInlinedFunctions() {
   auto number_of_inlined_closures = LoadPrimitive<int>();
   for (int i = 0; i < number_of_inlined_closures; ++i) {
     Handle<SharedFunctionInfo> shared_info = LoadSharedFunctionInfo();
-    RETURN_VALUE_ON_FAIL(nullptr);
+    RETURN_ON_FAIL();
 
     if (shared_info->has_deoptimization_support()) {
       continue;
@@ -463,11 +503,9 @@ LChunk* LChunkLoader::Load() {
         PrintF("\n");
       }
       Fail("could not ensure deoptimization support for inlined function");
-      return nullptr;
+      return;
     }
   }
-
-  return chunk();
 }
 
 
@@ -480,6 +518,7 @@ void LChunkLoader::LoadBasicBlocks() {
   List<InlineReturnTargetRecord> inline_return_target_records;
 
   auto number_of_blocks = LoadPrimitive<int>();
+  int last_instruction_index = -1;
   for (int block_index = 0; block_index < number_of_blocks; block_index++) {
     HBasicBlock* bb;
     if (block_index == 0)
@@ -487,7 +526,7 @@ void LChunkLoader::LoadBasicBlocks() {
     else {
       bb = graph->CreateBasicBlock();
 
-      auto ast_id = LoadPrimitive<BailoutId>();
+      BailoutId ast_id(LoadPrimitive<int>());
 
       auto env = new (zone())
         HEnvironment(NULL, info()->scope(), info()->closure(), zone());
@@ -526,8 +565,9 @@ void LChunkLoader::LoadBasicBlocks() {
       bb->MarkAsOrdered();
     }
 
-    auto first_instruction_index = LoadPrimitive<int>();
-    auto last_instruction_index = LoadPrimitive<int>();
+    int first_instruction_index =
+        last_instruction_index + LoadPrimitive<int>();
+    last_instruction_index = first_instruction_index + LoadPrimitive<int>();
     bb->set_first_instruction_index(first_instruction_index);
     bb->set_last_instruction_index(last_instruction_index);
   }
@@ -546,8 +586,9 @@ void LChunkLoader::LoadBasicBlocks() {
 
 void LChunkLoader::LoadConstants() {
   auto nof_value_pairs = LoadPrimitive<int>();
+  int last_id = 0;
   while (nof_value_pairs--) {
-    auto id = LoadPrimitive<int>();
+    auto id = LoadDelta(&last_id);
     auto constant = new(zone()) HConstantShim(LoadHConstantShim());
     RETURN_ON_FAIL();
     chunk()->SetValue(id, constant);
@@ -638,7 +679,7 @@ void LChunkLoader::LoadLGap(LGap* gap) {
 
 
 LLabel* LChunkLoader::LoadLLabel() {
-  auto id = LoadPrimitive<int>();
+  auto id = LoadBlockId();
   auto label = new(zone()) LLabel(chunk()->graph()->blocks()->at(id));
   LoadLGap(label);
   return label;
@@ -646,7 +687,7 @@ LLabel* LChunkLoader::LoadLLabel() {
 
 
 LInstructionGap* LChunkLoader::LoadLInstructionGap() {
-  auto id = LoadPrimitive<int>();
+  auto id = LoadBlockId();
   auto gap = new(zone()) LInstructionGap(chunk()->graph()->blocks()->at(id));
   LoadLGap(gap);
   return gap;
@@ -677,7 +718,7 @@ LParameter* LChunkLoader::LoadLParameter() {
 
 
 LGoto* LChunkLoader::LoadLGoto() {
-  auto id = LoadPrimitive<int>();
+  auto id = LoadBlockId();
   return new(zone()) LGoto(chunk()->graph()->blocks()->at(id));
 }
 
@@ -1526,16 +1567,99 @@ LTypeof* LChunkLoader::LoadLTypeof() {
 }
 
 
-#define DEFINE_LITHIUM_INSTRUCTION_SAVELOAD_STUBS(type) \
-  void LChunkSaver::SaveL##type(const L##type*) {       \
-    UNREACHABLE();                                      \
-  }                                                     \
-  L##type* LChunkLoader::LoadL##type() {                \
-    UNREACHABLE();                                      \
-    return NULL;                                        \
-  }
-  LITHIUM_INSTRUCTIONS_FOR_WHICH_SAVELOAD_IS_YET_TO_BE_IMPLEMENTED(DEFINE_LITHIUM_INSTRUCTION_SAVELOAD_STUBS)
-#undef DEFINE_LITHIUM_INSTRUCTION_SAVELOAD_STUBS
+LAllocateBlockContext* LChunkLoader::LoadLAllocateBlockContext() {
+  auto context = ConditionallyLoadLOperand();
+  auto function = ConditionallyLoadLOperand();
+  return new(zone()) LAllocateBlockContext(context, function);
+}
+
+
+LCallStub* LChunkLoader::LoadLCallStub() {
+  auto context = ConditionallyLoadLOperand();
+  return new(zone()) LCallStub(context);
+}
+
+
+LClampDToUint8* LChunkLoader::LoadLClampDToUint8() {
+  auto unclamped = ConditionallyLoadLOperand();
+  return new(zone()) LClampDToUint8(unclamped);
+}
+
+
+LClampIToUint8* LChunkLoader::LoadLClampIToUint8() {
+  auto unclamped = ConditionallyLoadLOperand();
+  return new(zone()) LClampIToUint8(unclamped);
+}
+
+
+LClampTToUint8* LChunkLoader::LoadLClampTToUint8() {
+  auto unclamped = ConditionallyLoadLOperand();
+  auto temp_xmm = ConditionallyLoadLOperand();
+  return new(zone()) LClampTToUint8(unclamped, temp_xmm);
+}
+
+
+LDateField* LChunkLoader::LoadLDateField() {
+  auto date = ConditionallyLoadLOperand();
+  auto index = LoadPrimitive<int>();
+  return new(zone()) LDateField(date, Smi::FromInt(index));
+}
+
+
+LDebugBreak* LChunkLoader::LoadLDebugBreak() {
+  return new(zone()) LDebugBreak();
+}
+
+
+LGetCachedArrayIndex* LChunkLoader::LoadLGetCachedArrayIndex() {
+  auto value = ConditionallyLoadLOperand();
+  return new(zone()) LGetCachedArrayIndex(value);
+}
+
+
+LSeqStringGetChar* LChunkLoader::LoadLSeqStringGetChar() {
+  auto string = ConditionallyLoadLOperand();
+  auto index = ConditionallyLoadLOperand();
+  return new(zone()) LSeqStringGetChar(string, index);
+}
+
+
+LSeqStringSetChar* LChunkLoader::LoadLSeqStringSetChar() {
+  auto context = ConditionallyLoadLOperand();
+  auto string = ConditionallyLoadLOperand();
+  auto index = ConditionallyLoadLOperand();
+  auto value = ConditionallyLoadLOperand();
+  return new(zone()) LSeqStringSetChar(context, string, index, value);
+}
+
+
+LStoreCodeEntry* LChunkLoader::LoadLStoreCodeEntry() {
+  auto function = ConditionallyLoadLOperand();
+  auto code_object = ConditionallyLoadLOperand();
+  return new(zone()) LStoreCodeEntry(function, code_object);
+}
+
+
+LStoreFrameContext* LChunkLoader::LoadLStoreFrameContext() {
+  auto context = ConditionallyLoadLOperand();
+  return new(zone()) LStoreFrameContext(context);
+}
+
+
+LTailCallThroughMegamorphicCache*
+LChunkLoader::LoadLTailCallThroughMegamorphicCache() {
+  auto context = ConditionallyLoadLOperand();
+  auto receiver = ConditionallyLoadLOperand();
+  auto name = ConditionallyLoadLOperand();
+  return new(zone()) LTailCallThroughMegamorphicCache(context, receiver, name);
+}
+
+
+LTrapAllocationMemento* LChunkLoader::LoadLTrapAllocationMemento() {
+  auto object = ConditionallyLoadLOperand();
+  auto temp = ConditionallyLoadLOperand();
+  return new(zone()) LTrapAllocationMemento(object, temp);
+}
 
 
 void LChunkSaver::SaveHydrogenShim(const LInstruction* instruction) {
@@ -1550,6 +1674,7 @@ HValueShim* LChunkLoader::LoadHydrogenShim(const LInstruction*) {
 // Constants have been already processed in a previous pass, reuse.
 #define DEFINE_HCONSTANT_SHIM_SAVELOAD(Constant)                        \
   void LChunkSaver::SaveHydrogenShim(const L##Constant* instr) {        \
+    if (leaves_out_ids()) return;                                       \
     SavePrimitive<int>(instr->hydrogen_shim()->id());                   \
   }                                                                     \
   HValueShim* LChunkLoader::LoadHydrogenShim(const L##Constant*) {      \
@@ -1576,8 +1701,8 @@ HValueShim* LChunkLoader::LoadHydrogenShim(const LInstruction*) {
 
 
 void LChunkSaver::SaveHValueShim(HValueShim* shim) {
-  SavePrimitive<int>(shim->id());
-  SavePrimitive<int>(shim->block_id());
+  SaveValueId(shim->id());
+  SaveBlockId(shim->block_id());
   SavePrimitive<int>(shim->position().raw());
   SaveRepresentation(shim->representation());
   SaveHType(shim->type());
@@ -1586,8 +1711,8 @@ void LChunkSaver::SaveHValueShim(HValueShim* shim) {
 
 
 HValueShim LChunkLoader::LoadHValueShim() {
-  auto id = LoadPrimitive<int>();
-  auto block_id = LoadPrimitive<int>();
+  auto id = LoadValueId();
+  auto block_id = LoadBlockId();
   HSourcePosition position(LoadPrimitive<int>());
   Representation representation = LoadRepresentation();
   HType type = LoadHType();
@@ -2700,4 +2825,670 @@ HTypeofIsAndBranchShim LChunkLoader::LoadHTypeofIsAndBranchShim() {
   return HTypeofIsAndBranchShim(base_shim, type_literal);
 }
 
+
+void LChunkSaver::SaveHAllocateBlockContextShim(
+    HAllocateBlockContextShim* shim) {
+  SaveHValueShim(shim);
+  SaveScopeInfo(*shim->scope_info());
+}
+
+
+HAllocateBlockContextShim LChunkLoader::LoadHAllocateBlockContextShim() {
+  auto base_shim = LoadHValueShim();
+  auto scope_info = LoadScopeInfo();
+  RETURN_VALUE_ON_FAIL(HAllocateBlockContextShim(/* failure */));
+  return HAllocateBlockContextShim(base_shim, scope_info);
+}
+
+
+void LChunkSaver::SaveHCallStubShim(HCallStubShim* shim) {
+  SaveHCallShim(shim);
+  SavePrimitive<CodeStub::Major>(shim->major_key());
+}
+
+
+HCallStubShim LChunkLoader::LoadHCallStubShim() {
+  auto base_shim = LoadHCallShim();
+  auto major_key = LoadPrimitive<CodeStub::Major>();
+  return HCallStubShim(base_shim, major_key);
+}
+
+
+void LChunkSaver::SaveHSeqStringGetCharShim(HSeqStringGetCharShim* shim) {
+  SaveHValueShim(shim);
+  SavePrimitive<String::Encoding>(shim->encoding());
+}
+
+
+HSeqStringGetCharShim LChunkLoader::LoadHSeqStringGetCharShim() {
+  auto base_shim = LoadHValueShim();
+  auto encoding = LoadPrimitive<String::Encoding>();
+  return HSeqStringGetCharShim(base_shim, encoding);
+}
+
+
+void LChunkSaver::SaveHSeqStringSetCharShim(HSeqStringSetCharShim* shim) {
+  SaveHValueShim(shim);
+  SavePrimitive<String::Encoding>(shim->encoding());
+}
+
+
+HSeqStringSetCharShim LChunkLoader::LoadHSeqStringSetCharShim() {
+  auto base_shim = LoadHValueShim();
+  auto encoding = LoadPrimitive<String::Encoding>();
+  return HSeqStringSetCharShim(base_shim, encoding);
+}
+
+
+void LChunkSaver::SaveHTailCallThroughMegamorphicCacheShim(
+    HTailCallThroughMegamorphicCacheShim* shim) {
+  SaveHValueShim(shim);
+  SavePrimitive<Code::Flags>(shim->flags());
+}
+
+
+HTailCallThroughMegamorphicCacheShim
+LChunkLoader::LoadHTailCallThroughMegamorphicCacheShim() {
+  auto base_shim = LoadHValueShim();
+  auto flags = LoadPrimitive<Code::Flags>();
+  return HTailCallThroughMegamorphicCacheShim(base_shim, flags);
+}
+
+
+// Machine code.
+//
+// The instructions and the relocation information are saved as they are,
+// followed by what each relocation entry refers to.  On load, the code is
+// allocated from the saved instructions and every entry is patched to point
+// to its target in this isolate.  Code that refers to anything that can't
+// be found again, e.g. cells, allocation sites or inner closures, is not
+// saved, and neither is code whose dependencies can't all be saved.
+
+// The relocation modes whose targets are saved.
+static const int kRelocatedModeMask =
+    RelocInfo::kCodeTargetMask |
+    RelocInfo::ModeMask(RelocInfo::EMBEDDED_OBJECT) |
+    RelocInfo::ModeMask(RelocInfo::RUNTIME_ENTRY) |
+    RelocInfo::ModeMask(RelocInfo::EXTERNAL_REFERENCE) |
+    RelocInfo::ModeMask(RelocInfo::INTERNAL_REFERENCE);
+
+
+static bool IsTargetOf(RelocationTargetType type, RelocInfo::Mode mode) {
+  switch (type) {
+    case kEmbeddedObjectTarget:
+      return mode == RelocInfo::EMBEDDED_OBJECT;
+    case kBuiltinTarget:
+    case kCodeStubTarget:
+    case kNonMonomorphicICTarget:
+      return RelocInfo::IsCodeTarget(mode);
+    case kDeoptimizationEntryTarget:
+      return RelocInfo::IsRuntimeEntry(mode);
+    case kExternalReferenceTarget:
+      return mode == RelocInfo::EXTERNAL_REFERENCE;
+    case kInternalReferenceTarget:
+      return RelocInfo::IsInternalReference(mode);
+  }
+  return false;
+}
+
+
+void LChunkSaver::SaveCode(const LChunk* chunk, Code* code) {
+  if (code->kind() != Code::OPTIMIZED_FUNCTION ||
+      code->is_turbofanned() != (chunk == nullptr)) {
+    Fail("not Crankshaft or TurboFan code");
+    return;
+  }
+  if (code->handler_table()->length()) {
+    Fail("code has a handler table");
+    return;
+  }
+
+  SavePrimitive<bool>(code->is_turbofanned());
+  SavePrimitive<unsigned>(code->stack_slots());
+  SavePrimitive<unsigned>(code->safepoint_table_offset());
+  SavePrimitive<int>(code->prologue_offset());
+  Synchronize();
+
+  RETURN_ON_FAIL(SaveDeoptimizationData(code->deoptimization_data()));
+  if (chunk) {
+    RETURN_ON_FAIL(SaveInlinedFunctions(chunk));
+  } else {
+    // The closures TurboFan inlined are not kept apart from the other
+    // literals of the deoptimization data.
+    if (info()->is_inlining_enabled() &&
+        code->deoptimization_data()->length()) {
+      Fail("TurboFan code with inlined functions");
+      return;
+    }
+    SavePrimitive<int>(0);
+  }
+  RETURN_ON_FAIL(SaveCodeDependencies(chunk));
+  Synchronize();
+
+  SavePrimitiveArray(Vector<const byte>(code->instruction_start(),
+                                        code->instruction_size()));
+  ByteArray* relocation_info = code->relocation_info();
+  SavePrimitiveArray(Vector<const byte>(
+      relocation_info->GetDataStartAddress(), relocation_info->length()));
+  RETURN_ON_FAIL(SaveRelocationTargets(code));
+  Synchronize();
+}
+
+
+Handle<Code> LChunkLoader::LoadCode() {
+  auto is_turbofanned = LoadPrimitive<bool>();
+  auto stack_slots = LoadPrimitive<unsigned>();
+  auto safepoint_table_offset = LoadPrimitive<unsigned>();
+  auto prologue_offset = LoadPrimitive<int>();
+  Synchronize();
+
+  Handle<FixedArray> deoptimization_data = LoadDeoptimizationData();
+  RETURN_VALUE_ON_FAIL(Handle<Code>::null());
+  RETURN_VALUE_ON_FAIL(Handle<Code>::null(), LoadInlinedFunctions());
+  ZoneList<Handle<Map> > dependencies(4, zone());
+  ZoneList<DependentCode::DependencyGroup> dependency_groups(4, zone());
+  RETURN_VALUE_ON_FAIL(Handle<Code>::null(),
+      LoadCodeDependencies(&dependencies, &dependency_groups));
+  Synchronize();
+
+  auto instructions = LoadPrimitiveArray<byte>();
+  auto relocation = LoadPrimitiveArray<byte>();
+  ZoneList<RelocationTarget> targets(16, zone());
+  RETURN_VALUE_ON_FAIL(Handle<Code>::null(), LoadRelocationTargets(&targets));
+  Synchronize();
+
+  // Everything is allocated up front, so that the code can be patched
+  // without allocating: the code must not move while it is patched, and the
+  // garbage collector must not see it before.  That is also why the code is
+  // allocated without relocation information, which is added afterwards;
+  // Code::CopyFrom would otherwise try to patch it on its own.
+  Factory* factory = isolate()->factory();
+  Handle<ByteArray> relocation_info =
+      factory->NewByteArray(relocation.length(), TENURED);
+  Assembler origin(isolate(), nullptr, 0);
+  CodeDesc desc;
+  desc.buffer = const_cast<byte*>(instructions.start());
+  desc.buffer_size = instructions.length();
+  desc.instr_size = instructions.length();
+  desc.reloc_size = 0;
+  desc.origin = &origin;
+  Handle<Code> code = factory->NewCode(desc, info()->flags(),
+                                       Handle<Object>::null(), false, true,
+                                       prologue_offset);
+
+  {
+    DisallowHeapAllocation no_allocation;
+
+    // Code must not refer to new space objects directly; see
+    // MacroAssembler::MoveHeapObject.
+    for (const RelocationTarget& target: targets) {
+      if (target.type == kEmbeddedObjectTarget &&
+          isolate()->heap()->InNewSpace(*target.object)) {
+        Fail("embedded object is in new space");
+        return Handle<Code>::null();
+      }
+    }
+
+    CopyBytes(relocation_info->GetDataStartAddress(), relocation.start(),
+              static_cast<size_t>(relocation.length()));
+    code->set_relocation_info(*relocation_info);
+
+    // The code is not yet known to the garbage collector, so there is no need
+    // for write barriers.
+    int index = 0;
+    for (RelocIterator it(*code, kRelocatedModeMask); !it.done();
+         it.next(), ++index) {
+      RelocInfo* rinfo = it.rinfo();
+      if (index == targets.length() ||
+          !IsTargetOf(targets[index].type, rinfo->rmode())) {
+        break;
+      }
+
+      const RelocationTarget& target = targets[index];
+      switch (target.type) {
+        case kEmbeddedObjectTarget:
+          rinfo->set_target_object(*target.object, SKIP_WRITE_BARRIER,
+                                   SKIP_ICACHE_FLUSH);
+          break;
+
+        case kBuiltinTarget:
+        case kCodeStubTarget:
+        case kNonMonomorphicICTarget:
+          rinfo->set_target_address(
+              Code::cast(*target.object)->instruction_start(),
+              SKIP_WRITE_BARRIER, SKIP_ICACHE_FLUSH);
+          break;
+
+        case kDeoptimizationEntryTarget:
+          rinfo->set_target_runtime_entry(target.address, SKIP_WRITE_BARRIER,
+                                          SKIP_ICACHE_FLUSH);
+          break;
+
+        case kExternalReferenceTarget:
+          Memory::Address_at(rinfo->pc()) = target.address;
+          break;
+
+        case kInternalReferenceTarget:
+          Memory::Address_at(rinfo->pc()) =
+              code->instruction_start() + target.offset;
+          break;
+      }
+    }
+
+    if (index != targets.length()) {
+      // Don't let the garbage collector look at what is left unpatched.
+      code->set_relocation_info(isolate()->heap()->empty_byte_array());
+      Fail("relocation targets don't match relocation information");
+      return Handle<Code>::null();
+    }
+  }
+
+  code->set_is_turbofanned(is_turbofanned);
+  code->set_stack_slots(stack_slots);
+  code->set_safepoint_table_offset(safepoint_table_offset);
+  code->set_deoptimization_data(*deoptimization_data);
+  CpuFeatures::FlushICache(code->instruction_start(),
+                           code->instruction_size());
+
+  LCodeGenBase::RegisterWeakObjectsInOptimizedCode(code, zone());
+  for (int i = 0; i < dependencies.length(); ++i) {
+    Map::AddDependentCode(dependencies[i], dependency_groups[i], code);
+  }
+
+  return code;
+}
+
+
+void LChunkSaver::SaveRelocatableObject(Object* object) {
+  // The object must come out of LoadObject as the very same object, or at
+  // least as one that can't be told apart from it.
+  bool relocatable;
+  if (object->IsSmi()) {
+    relocatable = true;
+  } else if (object->IsOddball()) {
+    switch (Oddball::cast(object)->kind()) {
+      case Oddball::kUndefined:
+      case Oddball::kTheHole:
+      case Oddball::kNull:
+      case Oddball::kTrue:
+      case Oddball::kFalse:
+      case Oddball::kUninitialized:
+      case Oddball::kException:
+        relocatable = true;
+        break;
+      default:
+        relocatable = false;
+        break;
+    }
+  } else if (object->IsSymbol()) {
+    relocatable = isolate()->heap()->RootIndex(Symbol::cast(object)) !=
+                  Heap::kNotFound;
+  } else if (object->IsSharedFunctionInfo()) {
+    relocatable = !SharedFunctionInfo::cast(object)->native();
+  } else {
+    relocatable = object->IsHeapNumber() ||
+                  object->IsString() ||
+                  object->IsMap() ||
+                  object->IsJSFunction() ||
+                  object->IsGlobalObject() ||
+                  object->IsJSGlobalProxy() ||
+                  object->IsNativeContext();
+  }
+
+  if (!relocatable) {
+    Fail("unrelocatable object in machine code");
+    return;
+  }
+  SaveObject(object);
+}
+
+
+void LChunkSaver::SaveDeoptimizationData(FixedArray* array) {
+  // Code without deoptimization points has an empty array.
+  if (!array->length()) {
+    SaveFalse();
+    return;
+  }
+  SaveTrue();
+
+  DeoptimizationInputData* data = DeoptimizationInputData::cast(array);
+  ByteArray* translations = data->TranslationByteArray();
+  SavePrimitiveArray(Vector<const byte>(translations->GetDataStartAddress(),
+                                        translations->length()));
+  SavePrimitive<int>(data->InlinedFunctionCount()->value());
+
+  FixedArray* literals = data->LiteralArray();
+  SavePrimitive<int>(literals->length());
+  for (int i = 0; i < literals->length(); ++i) {
+    RETURN_ON_FAIL(SaveRelocatableObject(literals->get(i)));
+  }
+
+  SavePrimitive<int>(data->OsrAstId()->value());
+  SavePrimitive<int>(data->OsrPcOffset()->value());
+
+  SavePrimitive<int>(data->DeoptCount());
+  for (int i = 0; i < data->DeoptCount(); ++i) {
+    SavePrimitive<int>(data->AstId(i).ToInt());
+    SavePrimitive<int>(data->TranslationIndex(i)->value());
+    SavePrimitive<int>(data->ArgumentsStackHeight(i)->value());
+    SavePrimitive<int>(data->Pc(i)->value());
+  }
+}
+
+
+Handle<FixedArray> LChunkLoader::LoadDeoptimizationData() {
+  Factory* factory = isolate()->factory();
+  if (!LoadBool()) {
+    return factory->empty_fixed_array();
+  }
+
+  auto translation_bytes = LoadPrimitiveArray<byte>();
+  Handle<ByteArray> translations =
+      factory->NewByteArray(translation_bytes.length(), TENURED);
+  CopyBytes(translations->GetDataStartAddress(), translation_bytes.start(),
+            static_cast<size_t>(translation_bytes.length()));
+  auto inlined_function_count = LoadPrimitive<int>();
+
+  auto number_of_literals = LoadPrimitive<int>();
+  Handle<FixedArray> literals =
+      factory->NewFixedArray(number_of_literals, TENURED);
+  for (int i = 0; i < number_of_literals; ++i) {
+    Handle<Object> literal = LoadObject();
+    RETURN_VALUE_ON_FAIL(Handle<FixedArray>::null());
+    literals->set(i, *literal);
+  }
+
+  auto osr_ast_id = LoadPrimitive<int>();
+  auto osr_pc_offset = LoadPrimitive<int>();
+  if (osr_ast_id != info()->osr_ast_id().ToInt()) {
+    Fail("OSR entry mismatch");
+    return Handle<FixedArray>::null();
+  }
+
+  auto deopt_count = LoadPrimitive<int>();
+  Handle<DeoptimizationInputData> data =
+      DeoptimizationInputData::New(isolate(), deopt_count, TENURED);
+  data->SetTranslationByteArray(*translations);
+  data->SetInlinedFunctionCount(Smi::FromInt(inlined_function_count));
+  data->SetOptimizationId(Smi::FromInt(info()->optimization_id()));
+  data->SetSharedFunctionInfo(*info()->shared_info());
+  data->SetLiteralArray(*literals);
+  data->SetOsrAstId(Smi::FromInt(osr_ast_id));
+  data->SetOsrPcOffset(Smi::FromInt(osr_pc_offset));
+  for (int i = 0; i < deopt_count; ++i) {
+    data->SetAstId(i, BailoutId(LoadPrimitive<int>()));
+    data->SetTranslationIndex(i, Smi::FromInt(LoadPrimitive<int>()));
+    data->SetArgumentsStackHeight(i, Smi::FromInt(LoadPrimitive<int>()));
+    data->SetPc(i, Smi::FromInt(LoadPrimitive<int>()));
+  }
+  return data;
+}
+
+
+// Dependencies are saved as (group, map) pairs, terminated by -1.  TurboFan
+// code has no chunk, only the dependencies committed by its info.
+void LChunkSaver::SaveCodeDependencies(const LChunk* chunk) {
+  if (chunk) {
+    for (const Handle<Map> map: chunk->deprecation_dependencies_) {
+      SavePrimitive<int>(DependentCode::kTransitionGroup);
+      RETURN_ON_FAIL(SaveMap(*map));
+    }
+
+    for (const Handle<Map> map: chunk->stability_dependencies_) {
+      SavePrimitive<int>(DependentCode::kPrototypeCheckGroup);
+      RETURN_ON_FAIL(SaveMap(*map));
+    }
+  }
+
+  for (int group = 0; group < DependentCode::kGroupCount; ++group) {
+    const ZoneList<Handle<HeapObject> >* objects =
+        info()->committed_dependencies(
+            static_cast<DependentCode::DependencyGroup>(group));
+    if (!objects) {
+      continue;
+    }
+    for (const Handle<HeapObject> object: *objects) {
+      if (!object->IsMap()) {
+        Fail("code depends on something other than a map");
+        return;
+      }
+      SavePrimitive<int>(group);
+      RETURN_ON_FAIL(SaveMap(Map::cast(*object)));
+    }
+  }
+
+  SavePrimitive<int>(-1);
+}
+
+
+void LChunkLoader::LoadCodeDependencies(
+    ZoneList<Handle<Map> >* maps,
+    ZoneList<DependentCode::DependencyGroup>* groups) {
+  for (int group = LoadPrimitive<int>(); group >= 0;
+       group = LoadPrimitive<int>()) {
+    Handle<Map> map = LoadMap();
+    RETURN_ON_FAIL();
+
+    // The code may only be used if what it assumes about the maps still
+    // holds; otherwise it would have to be deoptimized right away.
+    auto dependency_group = static_cast<DependentCode::DependencyGroup>(group);
+    if ((dependency_group == DependentCode::kTransitionGroup &&
+         map->is_deprecated()) ||
+        (dependency_group == DependentCode::kPrototypeCheckGroup &&
+         !map->is_stable())) {
+      Fail("code dependency does not hold");
+      return;
+    }
+
+    maps->Add(map, zone());
+    groups->Add(dependency_group, zone());
+  }
+}
+
+
+void LChunkSaver::SaveRelocationTargets(Code* code) {
+  int number_of_targets = 0;
+  for (RelocIterator it(code, kRelocatedModeMask); !it.done(); it.next()) {
+    number_of_targets++;
+  }
+  SavePrimitive<int>(number_of_targets);
+
+  for (RelocIterator it(code); !it.done(); it.next()) {
+    RelocInfo* rinfo = it.rinfo();
+    RelocInfo::Mode mode = rinfo->rmode();
+
+    if (mode == RelocInfo::EMBEDDED_OBJECT) {
+      SavePrimitive<RelocationTargetType>(kEmbeddedObjectTarget);
+      RETURN_ON_FAIL(SaveRelocatableObject(rinfo->target_object()));
+    } else if (RelocInfo::IsCodeTarget(mode)) {
+      RETURN_ON_FAIL(SaveCodeTarget(
+          Code::GetCodeFromTargetAddress(rinfo->target_address())));
+    } else if (RelocInfo::IsRuntimeEntry(mode)) {
+      // Calls to deoptimization entries.
+      Address entry = rinfo->target_address();
+      int id = Deoptimizer::kNotDeoptimizationEntry;
+      int type;
+      for (type = 0; type < Deoptimizer::kBailoutTypesWithCodeEntry; ++type) {
+        id = Deoptimizer::GetDeoptimizationId(
+            isolate(), entry, static_cast<Deoptimizer::BailoutType>(type));
+        if (id != Deoptimizer::kNotDeoptimizationEntry) {
+          break;
+        }
+      }
+      if (id == Deoptimizer::kNotDeoptimizationEntry) {
+        Fail("unrelocatable runtime entry");
+        return;
+      }
+      SavePrimitive<RelocationTargetType>(kDeoptimizationEntryTarget);
+      SavePrimitive<int>(type);
+      SavePrimitive<int>(id);
+    } else if (mode == RelocInfo::EXTERNAL_REFERENCE) {
+      Address address = rinfo->target_reference();
+      if (!external_reference_encoder_->IsKnown(address)) {
+        Fail("unknown external reference");
+        return;
+      }
+      SavePrimitive<RelocationTargetType>(kExternalReferenceTarget);
+      SavePrimitive<uint32_t>(external_reference_encoder_->Encode(address));
+    } else if (RelocInfo::IsInternalReference(mode)) {
+      Address target = Memory::Address_at(rinfo->pc());
+      SavePrimitive<RelocationTargetType>(kInternalReferenceTarget);
+      SavePrimitive<int>(static_cast<int>(target - code->instruction_start()));
+    } else if (!RelocInfo::IsPosition(mode) && !RelocInfo::IsComment(mode)) {
+      // E.g. cells, which are only used for objects in new space.
+      Fail("unsupported relocation mode");
+      return;
+    }
+  }
+}
+
+
+void LChunkLoader::LoadRelocationTargets(ZoneList<RelocationTarget>* targets) {
+  auto number_of_targets = LoadPrimitive<int>();
+  for (int i = 0; i < number_of_targets; ++i) {
+    RelocationTarget target;
+    target.type = LoadPrimitive<RelocationTargetType>();
+    target.address = nullptr;
+    target.offset = 0;
+
+    switch (target.type) {
+      case kEmbeddedObjectTarget:
+        target.object = LoadObject();
+        break;
+
+      case kBuiltinTarget:
+      case kCodeStubTarget:
+      case kNonMonomorphicICTarget:
+        target.object = LoadCodeTarget(target.type);
+        break;
+
+      case kDeoptimizationEntryTarget: {
+        auto type = LoadPrimitive<int>();
+        auto id = LoadPrimitive<int>();
+        if (type < 0 || type >= Deoptimizer::kBailoutTypesWithCodeEntry ||
+            id < 0) {
+          Fail("invalid deoptimization entry");
+          return;
+        }
+        target.address = Deoptimizer::GetDeoptimizationEntry(
+            isolate(), id, static_cast<Deoptimizer::BailoutType>(type));
+        if (!target.address) {
+          Fail("invalid deoptimization entry");
+          return;
+        }
+        break;
+      }
+
+      case kExternalReferenceTarget:
+        target.address =
+            external_reference_decoder_->Decode(LoadPrimitive<uint32_t>());
+        break;
+
+      case kInternalReferenceTarget:
+        target.offset = LoadPrimitive<int>();
+        break;
+
+      default:
+        Fail("invalid relocation target");
+        return;
+    }
+
+    RETURN_ON_FAIL();
+    targets->Add(target, zone());
+  }
+}
+
+
+void LChunkSaver::SaveCodeTarget(Code* target) {
+  // Builtins, including some ICs.  Only real builtins have a meaningful
+  // builtin index, so check that the code is the builtin itself.
+  int builtin_index = target->builtin_index();
+  if (builtin_index >= 0 && builtin_index < Builtins::builtin_count &&
+      isolate()->builtins()->builtin(
+          static_cast<Builtins::Name>(builtin_index)) == target) {
+    SavePrimitive<RelocationTargetType>(kBuiltinTarget);
+    SavePrimitive<int>(builtin_index);
+    return;
+  }
+
+  // Initial and generic load and store ICs, see PropertyICCompiler.
+  InlineCacheState ic_state = target->is_inline_cache_stub()
+      ? target->ic_state() : UNINITIALIZED;
+  if ((target->kind() == Code::LOAD_IC &&
+       (ic_state == UNINITIALIZED || ic_state == PREMONOMORPHIC)) ||
+      (target->kind() == Code::STORE_IC &&
+       (ic_state == UNINITIALIZED || ic_state == PREMONOMORPHIC ||
+        ic_state == GENERIC || ic_state == MEGAMORPHIC))) {
+    UnseededNumberDictionary* cache =
+        isolate()->heap()->non_monomorphic_cache();
+    int entry = cache->FindEntry(isolate(), target->flags());
+    if (entry != UnseededNumberDictionary::kNotFound &&
+        cache->ValueAt(entry) == target) {
+      SavePrimitive<RelocationTargetType>(kNonMonomorphicICTarget);
+      SavePrimitive<Code::Kind>(target->kind());
+      SavePrimitive<InlineCacheState>(ic_state);
+      SavePrimitive<ExtraICState>(target->extra_ic_state());
+      return;
+    }
+  }
+
+  // Code stubs, including ICs that are implemented as stubs.
+  if (target->IsCodeStubOrIC() && target->raw_type_feedback_info()->IsSmi()) {
+    uint32_t stub_key = target->stub_key();
+    if (CodeStub::MajorKeyFromKey(stub_key) != CodeStub::NoCache) {
+      SavePrimitive<RelocationTargetType>(kCodeStubTarget);
+      SavePrimitive<uint32_t>(stub_key);
+      return;
+    }
+  }
+
+  Fail("unrelocatable code target");
+}
+
+
+Handle<Code> LChunkLoader::LoadCodeTarget(RelocationTargetType type) {
+  switch (type) {
+    case kBuiltinTarget: {
+      auto builtin_index = LoadPrimitive<int>();
+      if (builtin_index >= 0 && builtin_index < Builtins::builtin_count) {
+        return handle(isolate()->builtins()->builtin(
+            static_cast<Builtins::Name>(builtin_index)));
+      }
+      break;
+    }
+
+    case kNonMonomorphicICTarget: {
+      auto kind = LoadPrimitive<Code::Kind>();
+      auto ic_state = LoadPrimitive<InlineCacheState>();
+      auto extra_ic_state = LoadPrimitive<ExtraICState>();
+      if (kind == Code::LOAD_IC) {
+        return PropertyICCompiler::ComputeLoad(isolate(), ic_state,
+                                               extra_ic_state);
+      }
+      if (kind == Code::STORE_IC) {
+        return PropertyICCompiler::ComputeStore(isolate(), ic_state,
+                                                extra_ic_state);
+      }
+      break;
+    }
+
+    case kCodeStubTarget: {
+      auto stub_key = LoadPrimitive<uint32_t>();
+      CodeStub::Major major_key = CodeStub::MajorKeyFromKey(stub_key);
+      Handle<Code> code;
+      if (major_key != CodeStub::NoCache &&
+          major_key < CodeStub::NUMBER_OF_IDS &&
+          CodeStub::GetCode(isolate(), stub_key).ToHandle(&code)) {
+        return code;
+      }
+      break;
+    }
+
+    default: break;
+  }
+
+  Fail("unrelocatable code target");
+  return Handle<Code>::null();
+}
+
 } }  // namespace v8::internal
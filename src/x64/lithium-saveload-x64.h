@@ -8,31 +8,34 @@
 namespace v8 {
 namespace internal {
 
-#define LITHIUM_INSTRUCTIONS_FOR_WHICH_SAVELOAD_IS_YET_TO_BE_IMPLEMENTED(V) \
-  V(AllocateBlockContext)                                               \
-  V(CallStub)                                                           \
-  V(ClampDToUint8)                                                      \
-  V(ClampIToUint8)                                                      \
-  V(ClampTToUint8)                                                      \
-  V(DateField)                                                          \
-  V(DebugBreak)                                                         \
-  V(GetCachedArrayIndex)                                                \
-  V(SeqStringGetChar)                                                   \
-  V(SeqStringSetChar)                                                   \
-  V(StoreCodeEntry)                                                     \
-  V(StoreFrameContext)                                                  \
-  V(TailCallThroughMegamorphicCache)                                    \
-  V(TrapAllocationMemento)                                              \
+// How the targets of relocation entries in saved machine code are found
+// again when it is loaded.
+enum RelocationTargetType {
+  kEmbeddedObjectTarget,
+  kBuiltinTarget,
+  kCodeStubTarget,
+  kNonMonomorphicICTarget,
+  kDeoptimizationEntryTarget,
+  kExternalReferenceTarget,
+  kInternalReferenceTarget
+};
+
 
 class LChunkSaver : public LChunkSaverBase {
  public:
-  LChunkSaver(List<char>& bytes, CompilationInfo* info)
-    : LChunkSaverBase(bytes, info),
+  LChunkSaver(List<char>& bytes, CompilationInfo* info,
+              SavedConstantPool* constants)
+    : LChunkSaverBase(bytes, info, constants),
       external_reference_encoder_(new ExternalReferenceEncoder(isolate())) {}
+  ~LChunkSaver() { delete external_reference_encoder_; }
 
   void Save(const LChunk*);
   void SaveInstruction(const LInstruction*);
 
+  // Machine code generated from the chunk, or TurboFan code, which has no
+  // chunk.
+  void SaveCode(const LChunk*, Code*);
+
   template<int R>
   void SaveTemplateResultInstruction(const LTemplateResultInstruction<R>*);
   template<int R, int I, int T>
@@ -61,6 +64,13 @@ class LChunkSaver : public LChunkSaverBase {
   void SaveConstants(const LChunk*);
   void SaveInstructions(const ZoneList<LInstruction*>*);
   void SaveLGap(const LGap*);
+  void SaveInlinedFunctions(const LChunk*);
+
+  void SaveRelocatableObject(Object*);
+  void SaveDeoptimizationData(FixedArray*);
+  void SaveCodeDependencies(const LChunk*);
+  void SaveRelocationTargets(Code*);
+  void SaveCodeTarget(Code*);
 
 #define DECLARE_HYDROGEN_SHIM_VALUE_SAVE(type)  \
   void Save##type(type*);
@@ -96,13 +106,16 @@ void LChunkSaver::SaveTemplateInstruction(const LTemplateInstruction<R, I, T>* i
 
 class LChunkLoader : public LChunkLoaderBase {
  public:
-  LChunkLoader(const List<char>& bytes, CompilationInfo* info)
-    : LChunkLoaderBase(bytes, info),
+  LChunkLoader(Vector<const char> bytes, CompilationInfo* info,
+               const SavedConstantPool* constants)
+    : LChunkLoaderBase(bytes, info, constants),
       external_reference_decoder_(new ExternalReferenceDecoder(isolate())) {}
 
   LChunk* Load();
   LInstruction* LoadInstruction();
 
+  Handle<Code> LoadCode();
+
   template<int R>
   void LoadTemplateResultInstruction(LTemplateResultInstruction<R>*);
 
@@ -129,6 +142,22 @@ class LChunkLoader : public LChunkLoaderBase {
   void LoadConstants();
   void LoadInstructions();
   void LoadLGap(LGap* instruction);
+  void LoadInlinedFunctions();
+
+  // A relocation target of the machine code, loaded before the code is
+  // allocated, so that the code can be patched without allocating.
+  struct RelocationTarget {
+    RelocationTargetType type;
+    Handle<Object> object;  // Embedded objects and code targets.
+    Address address;  // Deoptimization entries and external references.
+    int offset;  // Internal references.
+  };
+
+  Handle<FixedArray> LoadDeoptimizationData();
+  void LoadCodeDependencies(ZoneList<Handle<Map> >* maps,
+                            ZoneList<DependentCode::DependencyGroup>* groups);
+  void LoadRelocationTargets(ZoneList<RelocationTarget>* targets);
+  Handle<Code> LoadCodeTarget(RelocationTargetType);
 
 #define DECLARE_HYDROGEN_SHIM_VALUE_LOAD(type) \
   type Load##type();
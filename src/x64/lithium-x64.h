@@ -570,6 +570,7 @@ class LCallStub FINAL : public LTemplateInstruction<1, 1, 0> {
 
   DECLARE_CONCRETE_INSTRUCTION(CallStub, "call-stub")
   DECLARE_HYDROGEN_ACCESSOR(CallStub)
+  DECLARE_HYDROGEN_SHIM(CallStub)
 };
 
 
@@ -591,6 +592,7 @@ class LTailCallThroughMegamorphicCache FINAL
   DECLARE_CONCRETE_INSTRUCTION(TailCallThroughMegamorphicCache,
                                "tail-call-through-megamorphic-cache")
   DECLARE_HYDROGEN_ACCESSOR(TailCallThroughMegamorphicCache)
+  DECLARE_HYDROGEN_SHIM(TailCallThroughMegamorphicCache)
 };
 
 
@@ -1553,6 +1555,7 @@ class LSeqStringGetChar FINAL : public LTemplateInstruction<1, 2, 0> {
 
   DECLARE_CONCRETE_INSTRUCTION(SeqStringGetChar, "seq-string-get-char")
   DECLARE_HYDROGEN_ACCESSOR(SeqStringGetChar)
+  DECLARE_HYDROGEN_SHIM(SeqStringGetChar)
 };
 
 
@@ -1574,6 +1577,7 @@ class LSeqStringSetChar FINAL : public LTemplateInstruction<1, 4, 0> {
 
   DECLARE_CONCRETE_INSTRUCTION(SeqStringSetChar, "seq-string-set-char")
   DECLARE_HYDROGEN_ACCESSOR(SeqStringSetChar)
+  DECLARE_HYDROGEN_SHIM(SeqStringSetChar)
 };
 
 
@@ -2878,10 +2882,11 @@ class LAllocateBlockContext: public LTemplateInstruction<1, 2, 0> {
   LOperand* context() { return inputs_[0]; }
   LOperand* function() { return inputs_[1]; }
 
-  Handle<ScopeInfo> scope_info() { return hydrogen()->scope_info(); }
+  Handle<ScopeInfo> scope_info() { return hydrogen_shim()->scope_info(); }
 
   DECLARE_CONCRETE_INSTRUCTION(AllocateBlockContext, "allocate-block-context")
   DECLARE_HYDROGEN_ACCESSOR(AllocateBlockContext)
+  DECLARE_HYDROGEN_SHIM(AllocateBlockContext)
 };
 
 
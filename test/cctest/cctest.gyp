@@ -105,6 +105,7 @@
         'test-bit-vector.cc',
         'test-checks.cc',
         'test-circular-queue.cc',
+        'test-code-block-database.cc',
         'test-compiler.cc',
         'test-constantpool.cc',
         'test-conversions.cc',
@@ -132,6 +133,7 @@
         'test-heap-profiler.cc',
         'test-hydrogen-types.cc',
         'test-list.cc',
+        'test-lithium-validator.cc',
         'test-liveedit.cc',
         'test-lockers.cc',
         'test-log.cc',
@@ -148,6 +150,9 @@
         'test-reloc-info.cc',
         'test-representation.cc',
         'test-sampler-api.cc',
+        'test-saved-map-cache.cc',
+        'test-saved-type-feedback.cc',
+        'test-saveload.cc',
         'test-serialize.cc',
         'test-spaces.cc',
         'test-strings.cc',
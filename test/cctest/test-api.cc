@@ -40,6 +40,7 @@
 #include "src/api.h"
 #include "src/arguments.h"
 #include "src/base/platform/platform.h"
+#include "src/code-block-database.h"
 #include "src/compilation-cache.h"
 #include "src/cpu-profiler.h"
 #include "src/execution.h"
@@ -24207,3 +24208,90 @@ TEST(StreamingUtf8ScriptWithMultipleMultibyteCharactersSomeSplit2) {
   const char* chunks[] = {chunk1, chunk2, "foo();", NULL};
   RunStreamingTest(chunks, v8::ScriptCompiler::StreamedSource::UTF8);
 }
+
+
+// Gets what the code block database identifies the function |name| by.
+static void GetFunctionKey(const char* name, int* source_hash,
+                           int* start_position) {
+  i::Handle<i::JSFunction> function = v8::Utils::OpenHandle(
+      *v8::Local<v8::Function>::Cast(CompileRun(name)));
+  *source_hash =
+      i::Script::cast(function->shared()->script())->GetSourceHash();
+  *start_position = function->shared()->start_position();
+}
+
+
+TEST(ExportAndAddOptimizedCode) {
+  i::FLAG_allow_natives_syntax = true;
+  // The script is compiled again below, and must not be found in the cache.
+  i::FLAG_compilation_cache = false;
+  const char* source =
+      "function add(a, b) { return a + b; }\n"
+      "add(1, 2); add(3, 4);\n"
+      "%OptimizeFunctionOnNextCall(add);\n"
+      "add(5, 6);\n";
+
+  v8::ScriptCompiler::CollectOptimizedCode();
+  int add_hash, add_position;
+  {
+    LocalContext env;
+    v8::HandleScope scope(env->GetIsolate());
+    CompileRun(source);
+    CHECK(CompileRun("%GetOptimizationStatus(add)")->Int32Value() == 1);
+    GetFunctionKey("add", &add_hash, &add_position);
+  }
+
+  // Functions optimized after collecting stops are left out.
+  v8::ScriptCompiler::StopCollectingOptimizedCode();
+  int subtract_hash, subtract_position;
+  {
+    LocalContext env;
+    v8::HandleScope scope(env->GetIsolate());
+    CompileRun(
+        "function subtract(a, b) { return a - b; }\n"
+        "subtract(1, 2); subtract(3, 4);\n"
+        "%OptimizeFunctionOnNextCall(subtract);\n"
+        "subtract(5, 6);\n");
+    CHECK(CompileRun("%GetOptimizationStatus(subtract)")->Int32Value() == 1);
+    GetFunctionKey("subtract", &subtract_hash, &subtract_position);
+  }
+
+  v8::ScriptCompiler::CachedData* data =
+      v8::ScriptCompiler::ExportOptimizedCode();
+  CHECK(data != NULL);
+  CHECK_GT(data->length, 0);
+  {
+    i::CodeBlockDatabase database;
+    CHECK(database.Read(i::Vector<const char>(
+        reinterpret_cast<const char*>(data->data), data->length)));
+    CHECK(database.HasCode(i::CodeBlockDatabase::Key(add_hash,
+                                                     add_position)));
+    CHECK(!database.HasCode(i::CodeBlockDatabase::Key(subtract_hash,
+                                                      subtract_position)));
+  }
+
+  // Data that is cut short or saved by another V8 version is turned down.
+  v8::ScriptCompiler::CachedData truncated(data->data, 36);  // In the pools.
+  CHECK(!v8::ScriptCompiler::AddOptimizedCode(&truncated));
+  i::Vector<uint8_t> mismatched = i::Vector<uint8_t>::New(data->length);
+  i::MemCopy(mismatched.start(), data->data, data->length);
+  mismatched[8] ^= 0xff;  // Header::version_hash
+  v8::ScriptCompiler::CachedData other_version(mismatched.start(),
+                                               mismatched.length());
+  CHECK(!v8::ScriptCompiler::AddOptimizedCode(&other_version));
+  mismatched.Dispose();
+
+  // The exported code is used for the same script.
+  CHECK(v8::ScriptCompiler::AddOptimizedCode(data));
+  delete data;
+  {
+    LocalContext env;
+    v8::HandleScope scope(env->GetIsolate());
+    v8::Local<v8::Function> add = v8::Local<v8::Function>::Cast(
+        CompileRun("function add(a, b) { return a + b; }\n"
+                   "add(1, 2); add;"));
+    i::Handle<i::JSFunction> function = v8::Utils::OpenHandle(*add);
+    CHECK(function->IsOptimized());
+    CHECK(function->code()->is_loaded_code());
+  }
+}
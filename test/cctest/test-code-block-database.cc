@@ -0,0 +1,568 @@
+#include "src/v8.h"
+#include "test/cctest/cctest.h"
+
+#include "src/base/platform/elapsed-timer.h"
+#include "src/code-block-database.h"
+
+using namespace v8::internal;
+
+static const int kNumberOfBlocks = 100000;
+// Keep some distance between the blocks, so that we can also look up
+// positions for which there is no code.
+static const int kStartPositionStep = 7;
+static const int kSourceHash = 42;
+
+
+static Vector<const char> NewCodeBlock(int start_position) {
+  Vector<char> code = Vector<char>::New(sizeof(start_position));
+  memcpy(code.start(), &start_position, sizeof(start_position));
+  return Vector<const char>(code.start(), code.length());
+}
+
+
+static int CodeBlockPayload(Vector<const char> code) {
+  CHECK_EQ(static_cast<int>(sizeof(int)), code.length());
+  int payload;
+  memcpy(&payload, code.start(), sizeof(payload));
+  return payload;
+}
+
+
+static CodeBlockDatabase::Key BlockKey(int start_position) {
+  return CodeBlockDatabase::Key(kSourceHash, start_position);
+}
+
+
+static void CheckLookups(const CodeBlockDatabase& database, const char* kind) {
+  v8::base::ElapsedTimer timer;
+  timer.Start();
+
+  for (int i = 0; i < kNumberOfBlocks; ++i) {
+    int start_position = i * kStartPositionStep;
+    CHECK(database.HasCode(BlockKey(start_position)));
+    CHECK(!database.HasCode(BlockKey(start_position + 1)));
+    CHECK_EQ(start_position,
+             CodeBlockPayload(database.GetCode(BlockKey(start_position))));
+  }
+
+  if (FLAG_trace_saveload) {
+    PrintF("[%d lookups in %s database of %d blocks took %.3f ms]\n",
+           3 * kNumberOfBlocks, kind, kNumberOfBlocks,
+           timer.Elapsed().InMillisecondsF());
+  }
+}
+
+
+TEST(CodeBlockDatabaseLookup) {
+  CodeBlockDatabase database;
+
+  // Insert in reverse order, so that the saved index has to be sorted.
+  for (int i = kNumberOfBlocks - 1; i >= 0; --i) {
+    int start_position = i * kStartPositionStep;
+    database.SetCode(BlockKey(start_position), NewCodeBlock(start_position));
+  }
+
+  // Replace a block, then add and remove an extra one.
+  database.SetCode(BlockKey(0), NewCodeBlock(0));
+  CodeBlockDatabase::Key extra_key = BlockKey(kNumberOfBlocks *
+                                              kStartPositionStep);
+  CHECK(!database.RemoveCode(extra_key));
+  database.SetCode(extra_key, NewCodeBlock(-1));
+  CHECK(database.HasCode(extra_key));
+  CHECK(database.RemoveCode(extra_key));
+  CHECK(!database.HasCode(extra_key));
+
+  // The same position in another script is a different block.
+  CodeBlockDatabase::Key other_script_key(kSourceHash + 1, 0);
+  CHECK(!database.HasCode(other_script_key));
+  database.SetCode(other_script_key, NewCodeBlock(-1));
+  CHECK_EQ(-1, CodeBlockPayload(database.GetCode(other_script_key)));
+  CHECK_EQ(0, CodeBlockPayload(database.GetCode(BlockKey(0))));
+
+  // So is code entered on stack replacement.
+  CodeBlockDatabase::Key osr_key(kSourceHash, 0, 3);
+  CHECK(!database.HasCode(osr_key));
+  database.SetCode(osr_key, NewCodeBlock(-1));
+  CHECK_EQ(-1, CodeBlockPayload(database.GetCode(osr_key)));
+  CHECK_EQ(0, CodeBlockPayload(database.GetCode(BlockKey(0))));
+
+  CheckLookups(database, "in-memory");
+}
+
+
+TEST(CodeBlockDatabaseWriteAndRead) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 10;
+  Vector<char> file_name = Vector<char>::New(file_name_length + 1);
+  SNPrintF(file_name, "%s.lithium", FLAG_testing_serialization_file);
+
+  {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      int start_position = i * kStartPositionStep;
+      database.SetCode(BlockKey(start_position),
+                       NewCodeBlock(start_position));
+    }
+    database.Write(file_name.start());
+  }
+
+  {
+    CodeBlockDatabase database(file_name.start());
+    CheckLookups(database, "mapped");
+  }
+
+  file_name.Dispose();
+}
+
+
+TEST(CodeBlockDatabaseWriteAndReadInMemory) {
+  List<char> data;
+  {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      int start_position = i * kStartPositionStep;
+      database.SetCode(BlockKey(start_position),
+                       NewCodeBlock(start_position));
+    }
+    CHECK_EQ(kNumberOfBlocks, database.Write(&data));
+  }
+
+  {
+    CodeBlockDatabase database;
+    CHECK(database.Read(data.ToConstVector()));
+    // The database keeps a copy.
+    data.Clear();
+    CheckLookups(database, "in-memory");
+
+    // Data that isn't a database is rejected.
+    const char garbage[] = "not a database";
+    CHECK(!database.Read(Vector<const char>(garbage, sizeof(garbage))));
+  }
+}
+
+
+TEST(CodeBlockDatabaseReadEmbedded) {
+  List<char> data;
+  {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      int start_position = i * kStartPositionStep;
+      database.SetCode(BlockKey(start_position),
+                       NewCodeBlock(start_position));
+    }
+    database.Write(&data);
+  }
+
+  // The data is used in place, so it must outlive the database.
+  {
+    CodeBlockDatabase database;
+    CHECK(database.ReadEmbedded(data.ToConstVector()));
+    CheckLookups(database, "embedded");
+  }
+
+  // Data that isn't aligned is copied instead.
+  List<char> unaligned;
+  unaligned.Add('\0');
+  unaligned.AddAll(data);
+  {
+    CodeBlockDatabase database;
+    CHECK(database.ReadEmbedded(unaligned.ToConstVector() + 1));
+    CheckLookups(database, "unaligned");
+  }
+}
+
+
+TEST(CodeBlockDatabaseReadSeveralFiles) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 10;
+  Vector<char> first_file_name = Vector<char>::New(file_name_length + 1);
+  Vector<char> second_file_name = Vector<char>::New(file_name_length + 1);
+  Vector<char> source = Vector<char>::New(2 * file_name_length + 2);
+  SNPrintF(first_file_name, "%s.lithium1", FLAG_testing_serialization_file);
+  SNPrintF(second_file_name, "%s.lithium2", FLAG_testing_serialization_file);
+  SNPrintF(source, "%s,%s", first_file_name.start(), second_file_name.start());
+
+  // Each script has its blocks saved into a file of its own.
+  for (int script = 0; script < 2; ++script) {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      database.SetCode(CodeBlockDatabase::Key(script, i), NewCodeBlock(script));
+    }
+    database.Write(script ? second_file_name.start() : first_file_name.start());
+  }
+
+  {
+    CodeBlockDatabase database(source.start());
+    for (int script = 0; script < 2; ++script) {
+      for (int i = 0; i < kNumberOfBlocks; ++i) {
+        CodeBlockDatabase::Key key(script, i);
+        CHECK(database.HasCode(key));
+        CHECK_EQ(script, CodeBlockPayload(database.GetCode(key)));
+      }
+    }
+    CHECK(!database.HasCode(CodeBlockDatabase::Key(2, 0)));
+  }
+
+  source.Dispose();
+  second_file_name.Dispose();
+  first_file_name.Dispose();
+}
+
+
+class FileLookupThread : public v8::base::Thread {
+ public:
+  explicit FileLookupThread(const CodeBlockDatabase* database)
+      : Thread(Options("FileLookupThread")), database_(database) {}
+
+  virtual void Run() {
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      int start_position = i * kStartPositionStep;
+      CHECK(database_->HasCodeInFiles(BlockKey(start_position)));
+      CHECK_EQ(start_position,
+               CodeBlockPayload(
+                   database_->GetCodeFromFiles(BlockKey(start_position))));
+    }
+  }
+
+ private:
+  const CodeBlockDatabase* database_;
+};
+
+
+TEST(CodeBlockDatabaseLookupInFilesWhileReading) {
+  List<char> data;
+  List<char> other_data;
+  {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      int start_position = i * kStartPositionStep;
+      database.SetCode(BlockKey(start_position),
+                       NewCodeBlock(start_position));
+    }
+    database.Write(&data);
+  }
+  {
+    CodeBlockDatabase database;
+    database.SetCode(CodeBlockDatabase::Key(kSourceHash + 1, 0),
+                     NewCodeBlock(0));
+    database.Write(&other_data);
+  }
+
+  CodeBlockDatabase database;
+  CHECK(database.Read(data.ToConstVector()));
+  // Blocks saved during this run are not in any file.
+  database.SetCode(BlockKey(1), NewCodeBlock(1));
+  CHECK(database.HasCode(BlockKey(1)));
+  CHECK(!database.HasCodeInFiles(BlockKey(1)));
+
+  // Lookups in the files need no lock, even while more files are read.
+  FileLookupThread thread(&database);
+  thread.Start();
+  for (int i = 0; i < 100; ++i) {
+    CHECK(database.Read(other_data.ToConstVector()));
+  }
+  thread.Join();
+  CHECK(database.HasCodeInFiles(CodeBlockDatabase::Key(kSourceHash + 1, 0)));
+}
+
+
+TEST(CodeBlockDatabaseRejectsMismatches) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 10;
+  Vector<char> file_name = Vector<char>::New(file_name_length + 1);
+  SNPrintF(file_name, "%s.lithium", FLAG_testing_serialization_file);
+
+  {
+    CodeBlockDatabase database;
+    for (int i = 0; i < kNumberOfBlocks; ++i) {
+      database.SetCode(BlockKey(i), NewCodeBlock(i));
+    }
+    database.Write(file_name.start());
+  }
+
+  // Damage the code of the last block.
+  {
+    FILE* file = v8::base::OS::FOpen(file_name.start(), "r+b");
+    CHECK(file);
+    CHECK_EQ(0, fseek(file, -1, SEEK_END));
+    fputc(0x5a, file);
+    fclose(file);
+  }
+
+  {
+    CodeBlockDatabase database(file_name.start());
+    CHECK(database.HasCode(BlockKey(0)));
+    CHECK_EQ(0, CodeBlockPayload(database.GetCode(BlockKey(0))));
+    CHECK(database.GetCode(BlockKey(kNumberOfBlocks - 1)).is_empty());
+  }
+
+  // Same with the checksums verified in the background, which may race
+  // with the lookups.
+  {
+    CodeBlockDatabase database(file_name.start());
+    database.VerifyInBackground();
+    for (int i = 0; i < kNumberOfBlocks - 1; ++i) {
+      CHECK_EQ(i, CodeBlockPayload(database.GetCode(BlockKey(i))));
+    }
+    CHECK(database.GetCode(BlockKey(kNumberOfBlocks - 1)).is_empty());
+  }
+
+  // Code generated with different flags must not be loaded.
+  bool use_inlining = FLAG_use_inlining;
+  FLAG_use_inlining = !use_inlining;
+  {
+    CodeBlockDatabase database(file_name.start());
+    CHECK(!database.HasCode(BlockKey(0)));
+  }
+  FLAG_use_inlining = use_inlining;
+
+  file_name.Dispose();
+}
+
+
+TEST(CodeBlockDatabaseConstantPool) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 10;
+  Vector<char> file_name = Vector<char>::New(file_name_length + 1);
+  SNPrintF(file_name, "%s.lithium", FLAG_testing_serialization_file);
+  double number = 0.5;
+  Vector<const char> number_data(reinterpret_cast<const char*>(&number),
+                                 sizeof(number));
+
+  {
+    CodeBlockDatabase database;
+    SavedConstantPool* constants = database.NewConstants();
+    // Equal constants are added once.
+    CHECK_EQ(0, constants->Add(SavedConstantPool::kInternalizedString,
+                               CStrVector("length")));
+    CHECK_EQ(1, constants->Add(SavedConstantPool::kHeapNumber, number_data));
+    CHECK_EQ(0, constants->Add(SavedConstantPool::kInternalizedString,
+                               CStrVector("length")));
+    CHECK_EQ(2, constants->Add(SavedConstantPool::kInternalizedString,
+                               CStrVector("")));
+    database.SetCode(BlockKey(0), NewCodeBlock(0));
+
+    const SavedConstantPool* block_constants = nullptr;
+    database.GetCode(BlockKey(0), &block_constants);
+    CHECK_EQ(constants, block_constants);
+    database.Write(file_name.start());
+  }
+
+  {
+    CodeBlockDatabase database(file_name.start());
+    const SavedConstantPool* constants = nullptr;
+    CHECK_EQ(0, CodeBlockPayload(database.GetCode(BlockKey(0), &constants)));
+    CHECK(constants);
+    CHECK_NE(database.NewConstants()->id(), constants->id());
+    CHECK_EQ(3, constants->length());
+    CHECK_EQ(SavedConstantPool::kInternalizedString, constants->GetKind(0));
+    CHECK(constants->GetData(0) == CStrVector("length"));
+    CHECK_EQ(SavedConstantPool::kHeapNumber, constants->GetKind(1));
+    CHECK(constants->GetData(1) == number_data);
+    CHECK_EQ(0, constants->GetData(2).length());
+  }
+
+  // A damaged pool makes the whole file unusable.
+  {
+    FILE* file = v8::base::OS::FOpen(file_name.start(), "r+b");
+    CHECK(file);
+    // Past the header, the pool table and the index.
+    long constants_offset = (8 + 3 + 10) * sizeof(uint32_t);
+    CHECK_EQ(0, fseek(file, constants_offset, SEEK_SET));
+    fputc(0x5a, file);
+    fclose(file);
+  }
+
+  {
+    CodeBlockDatabase database(file_name.start());
+    CHECK(!database.HasCode(BlockKey(0)));
+  }
+
+  file_name.Dispose();
+}
+
+
+TEST(CodeBlockDatabaseMerge) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 10;
+  Vector<char> first_file_name = Vector<char>::New(file_name_length + 1);
+  Vector<char> merged_file_name = Vector<char>::New(file_name_length + 1);
+  SNPrintF(first_file_name, "%s.lithium1", FLAG_testing_serialization_file);
+  SNPrintF(merged_file_name, "%s.lithium2", FLAG_testing_serialization_file);
+  static const int kMergedBlocks = 10;
+
+  // The first run saves every block, after one deoptimization each.
+  {
+    CodeBlockDatabase database;
+    database.NewConstants()->Add(SavedConstantPool::kInternalizedString,
+                                 CStrVector("first"));
+    CodeBlockDatabase::Profile profile = { 1, 0 };
+    for (int i = 0; i < kMergedBlocks; ++i) {
+      database.SetCode(BlockKey(i), NewCodeBlock(i), profile);
+    }
+    database.Write(first_file_name.start());
+  }
+
+  // The second run replaces block 0 with code that deoptimized more often
+  // but inlined more, saves one more block and discards block 1.
+  for (int policy = CodeBlockDatabase::kNewest;
+       policy <= CodeBlockDatabase::kMostInlining; ++policy) {
+    {
+      CodeBlockDatabase database(first_file_name.start());
+      database.NewConstants()->Add(SavedConstantPool::kInternalizedString,
+                                   CStrVector("second"));
+      CodeBlockDatabase::Profile profile = { 2, 1 };
+      database.SetCode(BlockKey(0), NewCodeBlock(-1), profile);
+      database.SetCode(BlockKey(kMergedBlocks), NewCodeBlock(kMergedBlocks),
+                       profile);
+      CHECK(database.RemoveCode(BlockKey(1)));
+      CHECK(!database.RemoveCode(BlockKey(1)));
+      // Removed blocks can still be loaded during this run.
+      CHECK(database.HasCode(BlockKey(1)));
+      database.Write(merged_file_name.start(),
+                     static_cast<CodeBlockDatabase::MergePolicy>(policy));
+    }
+
+    CodeBlockDatabase database(merged_file_name.start());
+    CHECK(!database.HasCode(BlockKey(1)));
+    for (int i = 2; i <= kMergedBlocks; ++i) {
+      CHECK_EQ(i, CodeBlockPayload(database.GetCode(BlockKey(i))));
+    }
+
+    // Each block refers to the pool of the run that saved it.
+    const SavedConstantPool* constants = nullptr;
+    int expected = policy == CodeBlockDatabase::kFewestDeopts ? 0 : -1;
+    CHECK_EQ(expected,
+             CodeBlockPayload(database.GetCode(BlockKey(0), &constants)));
+    CHECK(constants->GetData(0) ==
+          CStrVector(expected == 0 ? "first" : "second"));
+    database.GetCode(BlockKey(2), &constants);
+    CHECK(constants->GetData(0) == CStrVector("first"));
+    database.GetCode(BlockKey(kMergedBlocks), &constants);
+    CHECK(constants->GetData(0) == CStrVector("second"));
+  }
+
+  // A database can be merged into the file it was read from.
+  {
+    CodeBlockDatabase database(merged_file_name.start());
+    database.SetCode(BlockKey(1), NewCodeBlock(1));
+    database.Write(merged_file_name.start());
+  }
+  {
+    CodeBlockDatabase database(merged_file_name.start());
+    for (int i = 1; i <= kMergedBlocks; ++i) {
+      CHECK_EQ(i, CodeBlockPayload(database.GetCode(BlockKey(i))));
+    }
+  }
+
+  merged_file_name.Dispose();
+  first_file_name.Dispose();
+}
+
+
+TEST(CodeBlockDatabaseGetRemovedCode) {
+  CodeBlockDatabase database;
+  database.SetCode(BlockKey(0), NewCodeBlock(0));
+  CHECK_EQ(0, CodeBlockPayload(database.GetCode(BlockKey(0))));
+
+  // Functions found to have code before it was removed still look it up.
+  CHECK(database.RemoveCode(BlockKey(0)));
+  CHECK(!database.HasCode(BlockKey(0)));
+  CHECK(database.GetCode(BlockKey(0)).is_empty());
+  CHECK(database.GetCodeFromFiles(BlockKey(0)).is_empty());
+}
+
+
+TEST(CodeBlockDatabaseGetStartPositions) {
+  List<char> data;
+  {
+    CodeBlockDatabase database;
+    database.SetCode(BlockKey(30), NewCodeBlock(30));
+    database.SetCode(BlockKey(10), NewCodeBlock(10));
+    database.SetCode(CodeBlockDatabase::Key(kSourceHash, 20, 5),
+                     NewCodeBlock(20));
+    database.SetCode(CodeBlockDatabase::Key(kSourceHash - 1, 40),
+                     NewCodeBlock(40));
+    database.SetCode(CodeBlockDatabase::Key(kSourceHash + 1, 50),
+                     NewCodeBlock(50));
+    database.Write(&data);
+  }
+
+  CodeBlockDatabase database;
+  CHECK(database.Read(data.ToConstVector()));
+  database.SetCode(BlockKey(10), NewCodeBlock(11));
+  database.SetCode(BlockKey(0), NewCodeBlock(0));
+  CHECK(database.RemoveCode(BlockKey(30)));
+
+  // Blocks for OSR, of other scripts or removed are left out, and blocks
+  // both read and added are only listed once.
+  List<int> start_positions;
+  start_positions.Add(-1);
+  database.GetStartPositions(kSourceHash, &start_positions);
+  CHECK_EQ(3, start_positions.length());
+  CHECK_EQ(-1, start_positions[0]);
+  CHECK_EQ(0, start_positions[1]);
+  CHECK_EQ(10, start_positions[2]);
+
+  start_positions.Clear();
+  database.GetStartPositions(kSourceHash + 2, &start_positions);
+  CHECK(start_positions.is_empty());
+}
+
+
+TEST(CodeBlockDatabaseKeepsReplacedCode) {
+  CodeBlockDatabase database;
+  database.SetCode(BlockKey(0), NewCodeBlock(0));
+  database.SetCode(BlockKey(1), NewCodeBlock(1));
+  Vector<const char> replaced = database.GetCode(BlockKey(0));
+  Vector<const char> removed = database.GetCode(BlockKey(1));
+
+  // Other isolates may still be loading the code they looked up.
+  database.SetCode(BlockKey(0), NewCodeBlock(2));
+  CHECK(database.RemoveCode(BlockKey(1)));
+  CHECK_EQ(2, CodeBlockPayload(database.GetCode(BlockKey(0))));
+  CHECK_EQ(0, CodeBlockPayload(replaced));
+  CHECK_EQ(1, CodeBlockPayload(removed));
+
+  // Constants added later do not move the ones looked up before.
+  SavedConstantPool* constants = database.NewConstants();
+  const char first[] = "first";
+  int index = constants->Add(SavedConstantPool::kInternalizedString,
+                             Vector<const char>(first, StrLength(first)));
+  Vector<const char> data = constants->GetData(index);
+  for (int i = 0; i < 1000; ++i) {
+    constants->Add(SavedConstantPool::kHeapNumber,
+                   Vector<const char>(reinterpret_cast<const char*>(&i),
+                                      sizeof(i)));
+  }
+  CHECK_EQ(1001, constants->length());
+  CHECK(data == constants->GetData(index));
+  CHECK_EQ(0, memcmp(data.start(), first, StrLength(first)));
+}
+
+
+
+// Saves blocks for two owners, as two isolates saving at once would, with
+// the owners taking turns in the given order.
+static void SaveInterleaved(bool owner_0_first, List<char>* data) {
+  static const int kBlocksPerOwner = 10;
+  CodeBlockDatabase database;
+  for (int i = 0; i < kBlocksPerOwner; ++i) {
+    for (int turn = 0; turn < 2; ++turn) {
+      int owner = (turn == 0) == owner_0_first ? 0 : 1;
+      int start_position = 2 * i + owner;
+      database.NewConstants(owner)->Add(
+          SavedConstantPool::kHeapNumber,
+          Vector<const char>(reinterpret_cast<const char*>(&start_position),
+                             sizeof(start_position)));
+      database.SetCode(BlockKey(start_position), NewCodeBlock(start_position),
+                       CodeBlockDatabase::Profile(), owner);
+    }
+  }
+  database.Write(data);
+}
+
+
+TEST(CodeBlockDatabaseWriteIsReproducible) {
+  List<char> first;
+  List<char> second;
+  SaveInterleaved(true, &first);
+  SaveInterleaved(false, &second);
+  CHECK_EQ(first.length(), second.length());
+  CHECK_EQ(0, memcmp(first.begin(), second.begin(), first.length()));
+}
@@ -0,0 +1,70 @@
+#include "src/v8.h"
+#include "test/cctest/cctest.h"
+
+#include "src/compiler.h"
+#include "src/lithium-validator.h"
+
+using namespace v8::internal;
+
+static const char* kGetSource = "function get(o) { return o.y; }";
+
+
+// Crankshafts |function| as far as its chunk, which lives in the zone of
+// |info|.
+static LChunk* BuildChunk(CompilationInfoWithZone* info,
+                          Handle<JSFunction> function) {
+  info->SetOptimizing(BailoutId::None(),
+                      Handle<Code>(function->shared()->code()));
+  OptimizedCompileJob* job = new(info->zone()) OptimizedCompileJob(info);
+  CHECK(Compiler::ParseAndAnalyze(info));
+  CHECK_EQ(OptimizedCompileJob::SUCCEEDED, job->CreateGraph());
+  CHECK_EQ(OptimizedCompileJob::SUCCEEDED, job->OptimizeGraph());
+  CHECK(job->chunk() != NULL);
+  return job->chunk();
+}
+
+
+TEST(LChunkValidatorSameFeedback) {
+  FLAG_allow_natives_syntax = true;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  CompileRun(kGetSource);
+  CompileRun("get({x: 1, y: 2}); get({x: 1, y: 2});");
+  Handle<JSFunction> get = v8::Utils::OpenHandle(
+      *v8::Handle<v8::Function>::Cast(CompileRun("get")));
+
+  CompilationInfoWithZone expected_info(get);
+  CompilationInfoWithZone actual_info(get);
+  LChunk* expected = BuildChunk(&expected_info, get);
+  LChunk* actual = BuildChunk(&actual_info, get);
+  LChunkValidator validator(expected, actual);
+  CHECK(validator.Validate());
+  CHECK_EQ(-1, validator.InstructionIndex());
+}
+
+
+TEST(LChunkValidatorMismatchedLayout) {
+  FLAG_allow_natives_syntax = true;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  CompileRun(kGetSource);
+  CompileRun("get({x: 1, y: 2}); get({x: 1, y: 2});");
+  Handle<JSFunction> get = v8::Utils::OpenHandle(
+      *v8::Handle<v8::Function>::Cast(CompileRun("get")));
+
+  CompilationInfoWithZone expected_info(get);
+  LChunk* expected = BuildChunk(&expected_info, get);
+
+  // The same instructions and operands, but for another map, with y at
+  // another offset.
+  CompileRun("%ClearFunctionTypeFeedback(get);"
+             "get({y: 2, x: 1}); get({y: 2, x: 1});");
+  CompilationInfoWithZone actual_info(get);
+  LChunk* actual = BuildChunk(&actual_info, get);
+
+  LChunkValidator validator(expected, actual);
+  CHECK(!validator.Validate());
+  CHECK_EQ(0, strcmp("hydrogen shim", validator.Reason()));
+  CHECK_EQ(0, strcmp(validator.ExpectedMnemonic(),
+                     validator.ActualMnemonic()));
+}
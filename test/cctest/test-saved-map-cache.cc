@@ -0,0 +1,94 @@
+#include "src/v8.h"
+#include "test/cctest/cctest.h"
+
+#include "src/saved-map-cache.h"
+
+using namespace v8::internal;
+
+static const int kPoolId = 3;
+
+
+static Vector<const char> SavedMap(const char* bytes) {
+  return Vector<const char>(bytes, StrLength(bytes));
+}
+
+
+static Handle<Map> NewMap() {
+  return CcTest::i_isolate()->factory()->NewMap(JS_OBJECT_TYPE,
+                                                JSObject::kHeaderSize);
+}
+
+
+TEST(SavedMapCacheLookup) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  SavedMapCache cache(CcTest::i_isolate());
+
+  Vector<const char> saved_map = SavedMap("saved map");
+  uint32_t hash = SavedMapCache::Hash(saved_map);
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_null());
+  Handle<Map> map = NewMap();
+  cache.Add(kPoolId, hash, saved_map, map);
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_identical_to(map));
+
+  // The saved form is copied.
+  char copy[] = "saved map";
+  CHECK(cache.Lookup(kPoolId, hash, SavedMap(copy)).is_identical_to(map));
+
+  // Maps saved the same way with other constant pools, or saved otherwise,
+  // are different.
+  CHECK(cache.Lookup(kPoolId + 1, hash, saved_map).is_null());
+  Vector<const char> other_saved_map = SavedMap("saved mat");
+  CHECK(cache.Lookup(kPoolId, hash, other_saved_map).is_null());
+  uint32_t other_hash = SavedMapCache::Hash(other_saved_map);
+  CHECK(cache.Lookup(kPoolId, other_hash, other_saved_map).is_null());
+
+  // Adding again replaces the map.
+  Handle<Map> other_map = NewMap();
+  cache.Add(kPoolId, hash, saved_map, other_map);
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_identical_to(other_map));
+}
+
+
+TEST(SavedMapCacheDropsDeprecatedMaps) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  SavedMapCache cache(CcTest::i_isolate());
+
+  Vector<const char> saved_map = SavedMap("saved map");
+  uint32_t hash = SavedMapCache::Hash(saved_map);
+  Handle<Map> map = NewMap();
+  cache.Add(kPoolId, hash, saved_map, map);
+  map->deprecate();
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_null());
+
+  // The entry is gone, so the up-to-date map can take its place.
+  Handle<Map> new_map = NewMap();
+  cache.Add(kPoolId, hash, saved_map, new_map);
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_identical_to(new_map));
+}
+
+
+TEST(SavedMapCacheClearedByGC) {
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  SavedMapCache cache(CcTest::i_isolate());
+
+  Vector<const char> saved_map = SavedMap("saved map");
+  uint32_t hash = SavedMapCache::Hash(saved_map);
+  Handle<Map> live_map = NewMap();
+  Vector<const char> live_saved_map = SavedMap("live map");
+  uint32_t live_hash = SavedMapCache::Hash(live_saved_map);
+  cache.Add(kPoolId, live_hash, live_saved_map, live_map);
+  {
+    v8::HandleScope inner_scope(CcTest::isolate());
+    cache.Add(kPoolId, hash, saved_map, NewMap());
+    CHECK(!cache.Lookup(kPoolId, hash, saved_map).is_null());
+  }
+
+  // The weak handle callback removes the entry of the dead map.
+  CcTest::heap()->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(cache.Lookup(kPoolId, hash, saved_map).is_null());
+  Handle<Map> found = cache.Lookup(kPoolId, live_hash, live_saved_map);
+  CHECK(found.is_identical_to(live_map));
+}
@@ -0,0 +1,186 @@
+#include "src/v8.h"
+#include "test/cctest/cctest.h"
+
+#include "src/compiler.h"
+#include "src/full-codegen.h"
+#include "src/ic/ic-state.h"
+#include "src/saved-type-feedback.h"
+
+using namespace v8::internal;
+
+static const char* kAddSource = "function add(a, b) { return a + b; }";
+static const char* kSubtractSource =
+    "function subtract(a, b) { return a - b; }";
+
+
+static Handle<JSFunction> CompileFunction(const char* source,
+                                          const char* name) {
+  CompileRun(source);
+  return v8::Utils::OpenHandle(
+      *v8::Handle<v8::Function>::Cast(CompileRun(name)));
+}
+
+
+static Vector<char> FeedbackFileName(const char* suffix) {
+  int file_name_length = StrLength(FLAG_testing_serialization_file) + 20;
+  Vector<char> file_name = Vector<char>::New(file_name_length + 1);
+  SNPrintF(file_name, "%s.%s.feedback", FLAG_testing_serialization_file,
+           suffix);
+  return file_name;
+}
+
+
+// Reads the state of the binary operation of |function| out of the feedback
+// file |file_name|.
+static bool FindBinaryOpState(const char* file_name,
+                              Handle<JSFunction> function, int* ast_id,
+                              uint32_t* state) {
+  int function_source_hash =
+      Script::cast(function->shared()->script())->GetSourceHash();
+  FILE* file = v8::base::OS::FOpen(file_name, "r");
+  CHECK(file);
+  int source_hash, start_position, kind;
+  bool found = false;
+  while (!found && fscanf(file, "%d %d %d %d %u", &source_hash,
+                          &start_position, ast_id, &kind, state) == 5) {
+    found = source_hash == function_source_hash &&
+            start_position == function->shared()->start_position() &&
+            kind == Code::BINARY_OP_IC;
+  }
+  fclose(file);
+  return found;
+}
+
+
+// Generates new full code for |function|, replays |feedback| into it and
+// returns the target of its binary operation.
+static Handle<Code> ReplayBinaryOp(SavedTypeFeedback* feedback,
+                                   Handle<JSFunction> function) {
+  CompilationInfoWithZone info(function);
+  CHECK(Compiler::ParseAndAnalyze(&info));
+  CHECK(FullCodeGenerator::MakeCode(&info));
+  feedback->Replay(&info);
+  int mask = RelocInfo::ModeMask(RelocInfo::CODE_TARGET_WITH_ID);
+  for (RelocIterator it(*info.code(), mask); !it.done(); it.next()) {
+    Code* target = Code::GetCodeFromTargetAddress(it.rinfo()->target_address());
+    if (target->kind() == Code::BINARY_OP_IC) {
+      return Handle<Code>(target);
+    }
+  }
+  UNREACHABLE();
+  return Handle<Code>::null();
+}
+
+
+TEST(SavedTypeFeedbackWriteAndRead) {
+  FLAG_compilation_cache = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Handle<JSFunction> add = CompileFunction(kAddSource, "add");
+  CompileRun("add(1, 2)");
+
+  Vector<char> recorded_name = FeedbackFileName("recorded");
+  Vector<char> rewritten_name = FeedbackFileName("rewritten");
+  {
+    SavedTypeFeedback feedback(nullptr);
+    feedback.Record(CcTest::i_isolate());
+    feedback.Write(recorded_name.start());
+  }
+  int ast_id;
+  uint32_t state;
+  CHECK(FindBinaryOpState(recorded_name.start(), add, &ast_id, &state));
+  BinaryOpICState recorded_state(CcTest::i_isolate(),
+                                 static_cast<ExtraICState>(state));
+  CHECK_EQ(Token::ADD, recorded_state.op());
+  CHECK(recorded_state.UseInlinedSmiCode());
+
+  // What is read is written back the same.
+  {
+    SavedTypeFeedback feedback(recorded_name.start());
+    feedback.Write(rewritten_name.start());
+  }
+  bool exists;
+  Vector<const char> recorded =
+      ReadFile(recorded_name.start(), &exists, false);
+  CHECK(exists);
+  Vector<const char> rewritten =
+      ReadFile(rewritten_name.start(), &exists, false);
+  CHECK(exists);
+  CHECK(recorded == rewritten);
+
+  recorded.Dispose();
+  rewritten.Dispose();
+  remove(recorded_name.start());
+  remove(rewritten_name.start());
+  recorded_name.Dispose();
+  rewritten_name.Dispose();
+}
+
+
+TEST(SavedTypeFeedbackReplay) {
+  FLAG_compilation_cache = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Handle<JSFunction> add = CompileFunction(kAddSource, "add");
+  CompileRun("add(1, 2)");
+
+  Vector<char> file_name = FeedbackFileName("replay");
+  {
+    SavedTypeFeedback feedback(nullptr);
+    feedback.Record(CcTest::i_isolate());
+    feedback.Write(file_name.start());
+  }
+  int ast_id;
+  uint32_t state;
+  CHECK(FindBinaryOpState(file_name.start(), add, &ast_id, &state));
+
+  // Fresh full code starts out uninitialized, and takes the recorded state.
+  SavedTypeFeedback empty(nullptr);
+  CHECK_EQ(UNINITIALIZED, ReplayBinaryOp(&empty, add)->ic_state());
+  SavedTypeFeedback feedback(file_name.start());
+  Handle<Code> target = ReplayBinaryOp(&feedback, add);
+  CHECK_NE(UNINITIALIZED, target->ic_state());
+  CHECK_EQ(static_cast<ExtraICState>(state), target->extra_ic_state());
+
+  remove(file_name.start());
+  file_name.Dispose();
+}
+
+
+TEST(SavedTypeFeedbackRejectsOpMismatch) {
+  FLAG_compilation_cache = false;
+  CcTest::InitializeVM();
+  v8::HandleScope scope(CcTest::isolate());
+  Handle<JSFunction> add = CompileFunction(kAddSource, "add");
+  Handle<JSFunction> subtract = CompileFunction(kSubtractSource, "subtract");
+  CompileRun("add(1, 2); subtract(1, 2)");
+
+  Vector<char> file_name = FeedbackFileName("mismatch");
+  {
+    SavedTypeFeedback feedback(nullptr);
+    feedback.Record(CcTest::i_isolate());
+    feedback.Write(file_name.start());
+  }
+  int add_ast_id, subtract_ast_id;
+  uint32_t add_state, subtract_state;
+  CHECK(FindBinaryOpState(file_name.start(), add, &add_ast_id, &add_state));
+  CHECK(FindBinaryOpState(file_name.start(), subtract, &subtract_ast_id,
+                          &subtract_state));
+
+  // Give the addition the state of the subtraction.
+  {
+    FILE* file = v8::base::OS::FOpen(file_name.start(), "w");
+    CHECK(file);
+    fprintf(file, "%d %d %d %d %u\n",
+            Script::cast(add->shared()->script())->GetSourceHash(),
+            add->shared()->start_position(), add_ast_id,
+            static_cast<int>(Code::BINARY_OP_IC), subtract_state);
+    fclose(file);
+  }
+
+  SavedTypeFeedback feedback(file_name.start());
+  CHECK_EQ(UNINITIALIZED, ReplayBinaryOp(&feedback, add)->ic_state());
+
+  remove(file_name.start());
+  file_name.Dispose();
+}
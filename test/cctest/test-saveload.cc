@@ -0,0 +1,390 @@
+#include "src/v8.h"
+#include "test/cctest/cctest.h"
+
+#include "src/code-block-database.h"
+#include "src/saveload.h"
+
+using namespace v8::internal;
+
+enum SmallEnum { kSmallValue = 1, kLargeValue = 300 };
+enum class SignedEnum : int16_t { kNegativeValue = -5 };
+
+
+TEST(SaveloadCompactIntegers) {
+  static const int kValues[] = {
+    0, 1, -1, 63, -64, 64, 127, 128, 300, -300, kMaxInt, kMinInt
+  };
+  List<char> bytes;
+  for (int value: kValues) {
+    SaveCompact<int>(bytes, value);
+  }
+  SaveCompact<size_t>(bytes, static_cast<size_t>(1) << 40);
+  SaveCompact<SmallEnum>(bytes, kLargeValue);
+  SaveCompact<SignedEnum>(bytes, SignedEnum::kNegativeValue);
+  SaveCompact<double>(bytes, 1.5);
+  SaveTrue(bytes);
+
+  const char* data = bytes.ToConstVector().start();
+  for (int value: kValues) {
+    CHECK_EQ(value, LoadCompact<int>(&data));
+  }
+  CHECK(LoadCompact<size_t>(&data) == static_cast<size_t>(1) << 40);
+  CHECK(LoadCompact<SmallEnum>(&data) == kLargeValue);
+  CHECK(LoadCompact<SignedEnum>(&data) == SignedEnum::kNegativeValue);
+  CHECK_EQ(1.5, LoadCompact<double>(&data));
+  CHECK(LoadBool(&data));
+  CHECK(data == bytes.ToConstVector().start() + bytes.length());
+}
+
+
+TEST(SaveloadCompactSize) {
+  List<char> bytes;
+  // Small values of either sign take a single byte.
+  SaveCompact<int>(bytes, 63);
+  SaveCompact<int>(bytes, -64);
+  SaveCompact<SmallEnum>(bytes, kSmallValue);
+  CHECK_EQ(3, bytes.length());
+
+  bytes.Clear();
+  SaveCompact<int>(bytes, kMinInt);
+  CHECK_EQ(5, bytes.length());
+}
+
+
+TEST(SaveloadCompactArray) {
+  static const int kArray[] = { 1, 2, 3 };
+  List<char> bytes;
+  // The leading byte leaves the elements misaligned.
+  SaveTrue(bytes);
+  SaveCompactArray<int>(bytes, Vector<const int>(kArray, arraysize(kArray)));
+  CHECK_EQ(static_cast<int>(2 + sizeof(kArray)), bytes.length());
+
+  const char* data = bytes.ToConstVector().start();
+  CHECK(LoadBool(&data));
+  List<int> array;
+  LoadCompactArray<int>(&data, &array);
+  CHECK_EQ(static_cast<int>(arraysize(kArray)), array.length());
+  for (int i = 0; i < array.length(); ++i) {
+    CHECK_EQ(kArray[i], array[i]);
+  }
+  CHECK(data == bytes.ToConstVector().start() + bytes.length());
+
+  // Bytes are loaded in place.
+  bytes.Clear();
+  SaveCompactArray<char>(bytes, CStrVector("abc"));
+  data = bytes.ToConstVector().start();
+  Vector<const char> chars = LoadCompactArray<char>(&data);
+  CHECK_EQ(3, chars.length());
+  CHECK(chars.start() == bytes.ToConstVector().start() + 1);
+}
+
+
+// Runs |prelude| and then |source| in a new context while collecting
+// optimized code, and adds the collected code for later contexts to load.
+// Returns the result of |source|.
+static int SaveAndAddOptimizedCode(const char* prelude, const char* source) {
+  FLAG_allow_natives_syntax = true;
+  // The script is compiled again, and must not be found in the cache.
+  FLAG_compilation_cache = false;
+  v8::Isolate* isolate = CcTest::isolate();
+
+  v8::ScriptCompiler::CollectOptimizedCode();
+  int result;
+  {
+    LocalContext env;
+    v8::HandleScope scope(isolate);
+    CompileRun(prelude);
+    result = CompileRun(source)->Int32Value();
+  }
+  v8::ScriptCompiler::CachedData* data =
+      v8::ScriptCompiler::ExportOptimizedCode();
+  CHECK(data != NULL);
+  CHECK(v8::ScriptCompiler::AddOptimizedCode(data));
+  delete data;
+  return result;
+}
+
+
+static Handle<JSFunction> GetFunction(const char* name) {
+  return v8::Utils::OpenHandle(
+      *v8::Local<v8::Function>::Cast(CompileRun(name)));
+}
+
+
+// Runs |source|, which optimizes |function_name|, while collecting optimized
+// code, and then again in another context with the collected code added.
+// The function must then get the saved code without deoptimizing it, and
+// |source| must compute the same result.  The code must be TurboFan code if
+// |turbofanned|.
+static void CheckSavedAndLoaded(const char* source, const char* function_name,
+                                bool turbofanned = false) {
+  int expected = SaveAndAddOptimizedCode("", source);
+  {
+    LocalContext env;
+    v8::HandleScope scope(CcTest::isolate());
+    CHECK_EQ(expected, CompileRun(source)->Int32Value());
+    Handle<JSFunction> function = GetFunction(function_name);
+    CHECK(function->IsOptimized());
+    CHECK(function->code()->is_loaded_code());
+    CHECK_EQ(turbofanned, function->code()->is_turbofanned());
+  }
+}
+
+
+TEST(SaveloadSelfReferentialPrototype) {
+  // The map of the nodes refers to itself through the field type of next,
+  // and to the map of its prototype, which holds a node.
+  CheckSavedAndLoaded(
+      "function Node(next) { this.next = next; }\n"
+      "Node.prototype.sentinel = new Node(null);\n"
+      "var list = new Node(new Node(Node.prototype.sentinel));\n"
+      "function length(node) {\n"
+      "  var n = 0;\n"
+      "  for (; node !== Node.prototype.sentinel; node = node.next) n++;\n"
+      "  return n;\n"
+      "}\n"
+      "length(list); length(list);\n"
+      "%OptimizeFunctionOnNextCall(length);\n"
+      "length(list);\n",
+      "length");
+}
+
+
+TEST(SaveloadOverwrittenTransition) {
+  // Adding a setter to the accessor replaces the descriptor of x, so the map
+  // of point is a copy of its parent with a transition keyed by x, which
+  // the map saver can't follow from the parent.
+  CheckSavedAndLoaded(
+      "var point = {};\n"
+      "Object.defineProperty(point, 'x', {\n"
+      "  get: function() { return 1; }, configurable: true });\n"
+      "Object.defineProperty(point, 'x', {\n"
+      "  set: function(value) {}, configurable: true });\n"
+      "function getX(p) { return p.x + 1; }\n"
+      "getX(point); getX(point);\n"
+      "%OptimizeFunctionOnNextCall(getX);\n"
+      "getX(point);\n",
+      "getX");
+}
+
+
+TEST(SaveloadPrewarm) {
+  // Only the run that saves calls the functions.
+  const char* source =
+      "function add(a, b) { return a + b; }\n"
+      "function outer() {\n"
+      "  return function inner(a) { return a + 1; };\n"
+      "}\n"
+      "var inner = outer();\n"
+      "if (this.warm) {\n"
+      "  add(1, 2); add(1, 2); inner(1); inner(1);\n"
+      "  %OptimizeFunctionOnNextCall(add);\n"
+      "  %OptimizeFunctionOnNextCall(inner);\n"
+      "  add(1, 2); inner(1);\n"
+      "}\n";
+  SaveAndAddOptimizedCode("var warm = true;", source);
+
+  // The top-level function is installed along with the script, the inner
+  // one along with its closure.
+  FLAG_saveload_prewarm = true;
+  {
+    LocalContext env;
+    v8::HandleScope scope(CcTest::isolate());
+    CompileRun(source);
+    for (const char* name: {"add", "inner"}) {
+      Handle<JSFunction> function = GetFunction(name);
+      CHECK(function->IsOptimized());
+      CHECK(function->code()->is_loaded_code());
+    }
+  }
+  FLAG_saveload_prewarm = false;
+}
+
+
+TEST(SaveloadSiblingInIIFE) {
+  // The saved code of run refers to helper through the context of the IIFE.
+  CheckSavedAndLoaded(
+      "var run = (function() {\n"
+      "  function helper(a) { return a + 1; }\n"
+      "  %NeverOptimizeFunction(helper);\n"
+      "  return function run(a) { return helper(a) * 2; };\n"
+      "})();\n"
+      "run(1); run(1);\n"
+      "%OptimizeFunctionOnNextCall(run);\n"
+      "run(1);\n",
+      "run");
+}
+
+
+TEST(SaveloadSiblingInModuleObject) {
+  // Here helper is a property of the object the context slot holds.
+  CheckSavedAndLoaded(
+      "var module = (function() {\n"
+      "  var api = {};\n"
+      "  api.helper = function(a) { return a + 1; };\n"
+      "  %NeverOptimizeFunction(api.helper);\n"
+      "  api.run = function(a) { return api.helper(a) * 2; };\n"
+      "  return api;\n"
+      "})();\n"
+      "var run = module.run;\n"
+      "run(1); run(1);\n"
+      "%OptimizeFunctionOnNextCall(run);\n"
+      "run(1);\n",
+      "run");
+}
+
+
+TEST(SaveloadReassignedContextSlot) {
+  // Only the run that loads replaces helper, after which the saved code of
+  // run must not be used.
+  const char* source =
+      "var run = (function() {\n"
+      "  function helper(a) { return a + 1; }\n"
+      "  %NeverOptimizeFunction(helper);\n"
+      "  if (this.reassign) helper = function(a) { return a + 2; };\n"
+      "  return function run(a) { return helper(a) * 2; };\n"
+      "})();\n"
+      "run(1); run(1);\n"
+      "%OptimizeFunctionOnNextCall(run);\n"
+      "run(1);\n";
+  CHECK_EQ(4, SaveAndAddOptimizedCode("", source));
+
+  LocalContext env;
+  v8::HandleScope scope(CcTest::isolate());
+  CompileRun("var reassign = true;");
+  CHECK_EQ(6, CompileRun(source)->Int32Value());
+  Handle<JSFunction> run = GetFunction("run");
+  CHECK(!run->code()->is_loaded_code());
+}
+
+
+TEST(SaveloadClampToUint8) {
+  // An int32, a double and a tagged value are clamped by the stores.
+  CheckSavedAndLoaded(
+      "var pixels = new Uint8ClampedArray(3);\n"
+      "function store(i, d, t) {\n"
+      "  pixels[0] = i | 0;\n"
+      "  pixels[1] = d + 0.25;\n"
+      "  pixels[2] = t;\n"
+      "  return pixels[0] + pixels[1] + pixels[2];\n"
+      "}\n"
+      "store(300, 1.5, -1); store(-4, 2.5, 1.5);\n"
+      "%OptimizeFunctionOnNextCall(store);\n"
+      "store(300, 1.5, 7);\n",
+      "store");
+}
+
+
+TEST(SaveloadSeqStringChars) {
+  // Adding to a long enough constant string is inlined, which copies the
+  // characters of flat results with SeqStringGetChar.
+  CheckSavedAndLoaded(
+      "var buffer = %NewString(2, true);\n"
+      "function build(s) {\n"
+      "  var t = 'abcdefghijkl' + s;\n"
+      "  %_OneByteSeqStringSetChar(0, 65, buffer);\n"
+      "  %_OneByteSeqStringSetChar(1, t.charCodeAt(12), buffer);\n"
+      "  return t.length + buffer.charCodeAt(0) + buffer.charCodeAt(1);\n"
+      "}\n"
+      "build('x'); build('y');\n"
+      "%OptimizeFunctionOnNextCall(build);\n"
+      "build('z');\n",
+      "build");
+}
+
+
+TEST(SaveloadDateField) {
+  CheckSavedAndLoaded(
+      "var date = new Date(2015, 5, 15);\n"
+      "function yearAndMonth(d) {\n"
+      "  return %_DateField(d, 1) + %_DateField(d, 2);\n"
+      "}\n"
+      "yearAndMonth(date); yearAndMonth(date);\n"
+      "%OptimizeFunctionOnNextCall(yearAndMonth);\n"
+      "yearAndMonth(date);\n",
+      "yearAndMonth");
+}
+
+
+TEST(SaveloadBlockContext) {
+  // y is captured, so the block allocates a context of its own.
+  FLAG_harmony_scoping = true;
+  CheckSavedAndLoaded(
+      "'use strict';\n"
+      "function sum(x) {\n"
+      "  var g;\n"
+      "  {\n"
+      "    let y = x + 1;\n"
+      "    g = function() { return y; };\n"
+      "  }\n"
+      "  return g() + x;\n"
+      "}\n"
+      "sum(1); sum(2);\n"
+      "%OptimizeFunctionOnNextCall(sum);\n"
+      "sum(3);\n",
+      "sum");
+}
+
+
+TEST(SaveloadCallStub) {
+  // %_SubString calls the SubString stub.
+  CheckSavedAndLoaded(
+      "function middle(s) { return %_SubString(s, 1, 3).length; }\n"
+      "middle('abcd'); middle('efgh');\n"
+      "%OptimizeFunctionOnNextCall(middle);\n"
+      "middle('ijkl');\n",
+      "middle");
+}
+
+
+TEST(SaveloadDeoptBelowLimitStopsSaving) {
+  // Code is collected while the added code is loaded, as when a run that
+  // loads code also saves it.
+  const char* source =
+      "function f(x) { return x + 1; }\n"
+      "f(1); f(1);\n"
+      "%OptimizeFunctionOnNextCall(f);\n"
+      "f(1);\n";
+  SaveAndAddOptimizedCode("", source);
+
+  LocalContext env;
+  v8::HandleScope scope(CcTest::isolate());
+  CompileRun(source);
+  Handle<JSFunction> f = GetFunction("f");
+  CHECK(f->code()->is_loaded_code());
+  CompileRun("%DeoptimizeFunction(f);");
+
+  // Below --saveload-deopt-limit the function may load its code again, but
+  // the code is no longer saved.
+  CHECK(f->shared()->has_saved_optimized_code());
+  v8::ScriptCompiler::CachedData* data =
+      v8::ScriptCompiler::ExportOptimizedCode();
+  CHECK(data != NULL);
+  CodeBlockDatabase database;
+  CHECK(database.Read(Vector<const char>(
+      reinterpret_cast<const char*>(data->data), data->length)));
+  delete data;
+  CHECK(!database.HasCode(CodeBlockDatabase::Key(
+      Script::cast(f->shared()->script())->GetSourceHash(),
+      f->shared()->start_position())));
+}
+
+
+TEST(SaveloadTurboFanCode) {
+  // TurboFan code is saved as machine code only, and must come back as
+  // TurboFan code.
+  FLAG_turbo_asm = true;
+  CheckSavedAndLoaded(
+      "function Module(stdlib) {\n"
+      "  'use asm';\n"
+      "  function add(a, b) {\n"
+      "    a = a | 0;\n"
+      "    b = b | 0;\n"
+      "    return (a + b) | 0;\n"
+      "  }\n"
+      "  return { add: add };\n"
+      "}\n"
+      "var add = Module(this).add;\n"
+      "add(1, 2);\n",
+      "add", true);
+}
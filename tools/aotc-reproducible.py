@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+"""Checks that aotc builds the same code block database every time.
+
+Runs aotc on a manifest twice and compares the outputs byte for byte:
+
+  tools/aotc-reproducible.py out/x64.release/aotc app.manifest
+  tools/aotc-reproducible.py --jobs=8 out/x64.release/aotc app.manifest
+
+Without a manifest, one is written that compiles the Octane benchmarks in
+benchmarks/ with the manifest's default number of jobs.  The output is then
+loaded by d8 (by default the one next to aotc) running the manifest's
+scripts with --load-code, which must accept it and load some of its code.
+The exit status is 1 if aotc failed, the outputs differ or d8 loaded
+nothing.
+"""
+
+import filecmp
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BENCHMARKS_DIR = os.path.join(ROOT, 'benchmarks')
+BENCHMARKS = [
+  'richards', 'deltablue', 'crypto', 'raytrace', 'earley-boyer', 'regexp',
+  'splay', 'navier-stokes'
+]
+
+
+def WriteManifest(path):
+  with open(path, 'w') as manifest:
+    manifest.write('script %s\n' % os.path.join(BENCHMARKS_DIR, 'base.js'))
+    for benchmark in BENCHMARKS:
+      manifest.write('script %s\n' %
+                     os.path.join(BENCHMARKS_DIR, benchmark + '.js'))
+
+
+def ReadManifest(path):
+  """Returns the flags and scripts of a manifest, resolved like aotc does."""
+  directory = os.path.dirname(path)
+  flags = []
+  scripts = []
+  with open(path) as manifest:
+    for line in manifest:
+      line = line.strip()
+      if not line or line.startswith('#'):
+        continue
+      parts = line.split(None, 1)
+      argument = parts[1] if len(parts) > 1 else ''
+      if parts[0] == 'flags':
+        flags += argument.split()
+      elif parts[0] == 'script' and argument:
+        scripts.append(os.path.join(directory, argument))
+  return flags, scripts
+
+
+def CheckLoads(d8, manifest, output):
+  """Returns whether d8 loads code from |output| with the manifest's flags."""
+  flags, scripts = ReadManifest(manifest)
+  process = subprocess.Popen(
+      [d8] + flags + ['--load-code=' + output, '--saveload-prewarm',
+                      '--trace-saveload'] + scripts,
+      stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+  text = process.communicate()[0].decode('utf-8', 'replace')
+  rejected = re.search(r'\[code block database ".*" rejected: (.*)\]', text)
+  if rejected:
+    print('d8 rejected the output: %s' % rejected.group(1))
+    return False
+  blocks = re.search(r'\[code block database ".*" (?:mapped|read), (\d+) '
+                     r'blocks\]', text)
+  loaded = len(re.findall(r'\[optimized code for \d+ loaded\]', text))
+  if not blocks or int(blocks.group(1)) == 0 or loaded == 0:
+    print('d8 loaded no code from the output')
+    return False
+  print('d8 loaded %d of %s blocks' % (loaded, blocks.group(1)))
+  return True
+
+
+def RunAotc(aotc, flags, manifest, output):
+  """Returns the exit code and the output of aotc."""
+  process = subprocess.Popen([aotc] + flags + [manifest, output],
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+  text = process.communicate()[0]
+  return process.returncode, text
+
+
+def Main():
+  parser = optparse.OptionParser(usage='%prog [options] aotc [manifest]')
+  parser.add_option('--jobs', type='int', default=0,
+                    help='--aotc-jobs to pass, 0 for the manifest\'s')
+  parser.add_option('--flags', default='', help='extra aotc flags')
+  parser.add_option('--d8', help='d8 to load the output with')
+  (options, args) = parser.parse_args()
+  if len(args) not in [1, 2]:
+    parser.print_help()
+    return 1
+  aotc = os.path.abspath(args[0])
+  d8 = os.path.abspath(options.d8 or
+                       os.path.join(os.path.dirname(aotc), 'd8'))
+
+  work_dir = tempfile.mkdtemp(prefix='aotc-reproducible')
+  try:
+    if len(args) == 2:
+      manifest = os.path.abspath(args[1])
+    else:
+      manifest = os.path.join(work_dir, 'octane.manifest')
+      WriteManifest(manifest)
+    flags = options.flags.split()
+    if options.jobs:
+      flags.append('--aotc-jobs=%d' % options.jobs)
+
+    outputs = []
+    for run in range(2):
+      output = os.path.join(work_dir, 'run%d.lithium' % run)
+      code, text = RunAotc(aotc, flags, manifest, output)
+      if code != 0:
+        sys.stderr.write('aotc failed on run %d\n%s' % (run + 1, text))
+        return 1
+      outputs.append(output)
+
+    if not filecmp.cmp(outputs[0], outputs[1], shallow=False):
+      print('outputs differ: %d and %d bytes' %
+            (os.path.getsize(outputs[0]), os.path.getsize(outputs[1])))
+      return 1
+    print('outputs are identical, %d bytes' % os.path.getsize(outputs[0]))
+    if not CheckLoads(d8, manifest, outputs[0]):
+      return 1
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(Main())
@@ -30,6 +30,8 @@
     'icu_use_data_file_flag%': 0,
     'v8_code': 1,
     'v8_random_seed%': 314159265,
+    # A code block database to embed in the snapshot, see --embed-code.
+    'v8_embed_code%': '',
   },
   'includes': ['../../build/toolchain.gypi', '../../build/features.gypi'],
   'targets': [
@@ -184,6 +186,9 @@
               ['v8_random_seed!=0', {
                 'mksnapshot_flags': ['--random-seed', '<(v8_random_seed)'],
               }],
+              ['v8_embed_code!=""', {
+                'mksnapshot_flags': ['--embed-code', '<(v8_embed_code)'],
+              }],
             ],
           },
           'action': [
@@ -305,6 +310,9 @@
                   ['v8_random_seed!=0', {
                     'mksnapshot_flags': ['--random-seed', '<(v8_random_seed)'],
                   }],
+                  ['v8_embed_code!=""', {
+                    'mksnapshot_flags': ['--embed-code', '<(v8_embed_code)'],
+                  }],
                 ],
               },
               'action': [
@@ -692,6 +700,8 @@
         '../../src/isolate.h',
         '../../src/json-parser.h',
         '../../src/json-stringifier.h',
+        '../../src/jsfunction-registry.cc',
+        '../../src/jsfunction-registry.h',
         '../../src/jsregexp-inl.h',
         '../../src/jsregexp.cc',
         '../../src/jsregexp.h',
@@ -707,6 +717,8 @@
         '../../src/lithium-codegen.h',
         '../../src/lithium-saveload.cc',
         '../../src/lithium-saveload.h',
+        '../../src/lithium-validator.cc',
+        '../../src/lithium-validator.h',
         '../../src/lithium.cc',
         '../../src/lithium.h',
         '../../src/lithium-inl.h',
@@ -798,6 +810,14 @@
         '../../src/safepoint-table.h',
         '../../src/sampler.cc',
         '../../src/sampler.h',
+        '../../src/saved-deopt-profile.cc',
+        '../../src/saved-deopt-profile.h',
+        '../../src/saved-map-cache.cc',
+        '../../src/saved-map-cache.h',
+        '../../src/saved-type-feedback.cc',
+        '../../src/saved-type-feedback.h',
+        '../../src/saveload-report.cc',
+        '../../src/saveload-report.h',
         '../../src/saveload.h',
         '../../src/scanner-character-streams.cc',
         '../../src/scanner-character-streams.h',
@@ -1753,5 +1773,29 @@
         }],
       ],
     },
+    {
+      'target_name': 'aotc',
+      'type': 'executable',
+      'dependencies': ['v8_base', 'v8_nosnapshot', 'v8_libplatform'],
+      'include_dirs+': [
+        '../..',
+      ],
+      'sources': [
+        '../../src/aotc.cc',
+      ],
+      'conditions': [
+        ['v8_enable_i18n_support==1', {
+          'dependencies': [
+            '<(icu_gyp_path):icui18n',
+            '<(icu_gyp_path):icuuc',
+          ]
+        }],
+        ['want_separate_host_toolset==1', {
+          'toolsets': ['host'],
+        }, {
+          'toolsets': ['target'],
+        }],
+      ],
+    },
   ],
 }
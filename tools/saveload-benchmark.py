@@ -0,0 +1,155 @@
+#!/usr/bin/env python
+"""Compares saved code size and load time between d8 builds.
+
+For every Octane benchmark in benchmarks/, each d8 saves the optimized code
+of the benchmark, then runs it again loading that code.  The size of the
+saved file and the time spent in V8.Saveload (the time it took to load and
+install the saved code, from --log-internal-timer-events) are reported, so
+that builds with different save formats can be compared:
+
+  tools/saveload-benchmark.py out/x64.release.old/d8 out/x64.release/d8
+
+Every build after the first one is also reported relative to the first one,
+as the percentage change of the size and of the load time.
+"""
+
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BENCHMARKS_DIR = os.path.join(ROOT, 'benchmarks')
+BENCHMARKS = [
+  'richards', 'deltablue', 'crypto', 'raytrace', 'earley-boyer', 'regexp',
+  'splay', 'navier-stokes'
+]
+
+# Runs the suites defined by the loaded benchmark, without printing scores.
+DRIVER = """
+BenchmarkSuite.RunSuites({ NotifyError: function(name, error) {
+  print(name + ': ' + error);
+  quit(1);
+}});
+"""
+
+TIMER_EVENT_RE = re.compile(r'^timer-event-(start|end),"V8.Saveload",(\d+)$')
+
+
+def SaveloadTime(log_file):
+  """Returns the total time in V8.Saveload, in milliseconds."""
+  total = 0
+  start = None
+  with open(log_file) as log:
+    for line in log:
+      match = TIMER_EVENT_RE.match(line.strip())
+      if not match:
+        continue
+      if match.group(1) == 'start':
+        start = int(match.group(2))
+      elif start is not None:
+        total += int(match.group(2)) - start
+        start = None
+  return total / 1000.0
+
+
+def RunD8(d8, flags, benchmark, driver, log_file):
+  command = [d8, '--saveload-edge'] + flags + [
+    '--log-internal-timer-events', '--logfile=%s' % log_file,
+    os.path.join(BENCHMARKS_DIR, 'base.js'),
+    os.path.join(BENCHMARKS_DIR, benchmark + '.js'),
+    driver
+  ]
+  with open(os.devnull, 'w') as devnull:
+    if subprocess.call(command, stdout=devnull, cwd=BENCHMARKS_DIR):
+      sys.stderr.write('failed: %s\n' % ' '.join(command))
+      sys.exit(1)
+
+
+def Measure(d8, benchmark, options, work_dir):
+  """Returns the saved file size in bytes and the mean load time in ms."""
+  driver = os.path.join(work_dir, 'driver.js')
+  code_file = os.path.join(work_dir, benchmark + '.lithium')
+  log_file = os.path.join(work_dir, 'v8.log')
+  extra_flags = options.flags.split()
+
+  if os.path.exists(code_file):
+    os.remove(code_file)
+  RunD8(d8, extra_flags + ['--save-code', code_file], benchmark, driver,
+        log_file)
+  size = os.path.getsize(code_file)
+
+  times = []
+  for _ in range(options.runs):
+    RunD8(d8, extra_flags + ['--load-code', code_file], benchmark, driver,
+          log_file)
+    times.append(SaveloadTime(log_file))
+  return size, sum(times) / len(times)
+
+
+def Change(value, base):
+  """Formats the change from |base| to |value| as a percentage."""
+  if not base:
+    return '%8s' % 'n/a'
+  return '%+7.1f%%' % (100.0 * (value - base) / base)
+
+
+def FormatRow(name, results):
+  """Formats the sizes and load times of every build, with the changes of
+  every build after the first one relative to the first one."""
+  row = '%-14s' % name
+  base_size, base_time = results[0]
+  for i, (size, time) in enumerate(results):
+    row += ' %12d %8.2fms' % (size, time)
+    if i:
+      row += ' %s %s' % (Change(size, base_size), Change(time, base_time))
+  return row
+
+
+def Main():
+  parser = optparse.OptionParser(usage='%prog [options] d8...')
+  parser.add_option('--runs', type='int', default=5,
+                    help='number of loading runs per benchmark')
+  parser.add_option('--flags', default='',
+                    help='extra d8 flags, e.g. --saveload-machine-code')
+  parser.add_option('--benchmarks', default=','.join(BENCHMARKS),
+                    help='comma-separated list of benchmarks to run')
+  (options, d8s) = parser.parse_args()
+  if not d8s:
+    parser.print_help()
+    return 1
+
+  work_dir = tempfile.mkdtemp(prefix='saveload-benchmark')
+  try:
+    with open(os.path.join(work_dir, 'driver.js'), 'w') as driver:
+      driver.write(DRIVER)
+
+    header = '%-14s' % 'benchmark'
+    for i in range(len(d8s)):
+      header += ' %12s %10s' % ('size#%d' % i, 'load#%d' % i)
+      if i:
+        header += ' %8s %8s' % ('size', 'load')
+    print(header)
+    for i, d8 in enumerate(d8s):
+      print('  #%d: %s' % (i, d8))
+
+    totals = [[0, 0.0] for _ in d8s]
+    for benchmark in options.benchmarks.split(','):
+      results = []
+      for i, d8 in enumerate(d8s):
+        size, time = Measure(os.path.abspath(d8), benchmark, options, work_dir)
+        totals[i][0] += size
+        totals[i][1] += time
+        results.append((size, time))
+      print(FormatRow(benchmark, results))
+    print(FormatRow('total', totals))
+  finally:
+    shutil.rmtree(work_dir)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(Main())
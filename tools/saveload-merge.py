@@ -0,0 +1,60 @@
+#!/usr/bin/env python
+"""Merges code block databases saved by several training runs.
+
+The inputs are loaded into d8 with --load-code and written out as one file
+with --save-code, without running any script, so that the output has the
+code of every function saved by any of the runs.  Where several runs saved
+code for the same function, --policy picks the one to keep:
+
+  tools/saveload-merge.py --d8 out/x64.release/d8 -o app.lithium \\
+      --policy fewest-deopts run1.lithium run2.lithium
+
+The output may be one of the inputs.  d8 must be the build that saved the
+inputs, and --flags must repeat the flags that affect the generated code;
+inputs saved with other flags are dropped.
+"""
+
+import optparse
+import os
+import subprocess
+import sys
+
+POLICIES = ['newest', 'fewest-deopts', 'most-inlining']
+
+
+def Main():
+  parser = optparse.OptionParser(usage='%prog [options] database...')
+  parser.add_option('--d8', default='d8', help='d8 to merge with')
+  parser.add_option('-o', '--output', help='file to save the merged code to')
+  parser.add_option('--policy', choices=POLICIES, default='newest',
+                    help='which code to keep for a function saved by '
+                         'several runs: %s' % ', '.join(POLICIES))
+  parser.add_option('--flags', default='',
+                    help='extra d8 flags the inputs were saved with')
+  parser.add_option('--verbose', action='store_true',
+                    help='trace what is loaded and saved')
+  (options, databases) = parser.parse_args()
+  if not databases or not options.output:
+    parser.print_help()
+    return 1
+  for database in databases:
+    if not os.path.exists(database):
+      sys.stderr.write('%s does not exist\n' % database)
+      return 1
+
+  command = [options.d8] + options.flags.split() + [
+    '--load-code', ','.join(databases),
+    '--save-code', options.output,
+    '--saveload-merge-policy', options.policy,
+    '-e', ''
+  ]
+  if options.verbose:
+    command.append('--trace-saveload')
+  if subprocess.call(command):
+    sys.stderr.write('failed: %s\n' % ' '.join(command))
+    return 1
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(Main())
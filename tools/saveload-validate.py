@@ -0,0 +1,166 @@
+#!/usr/bin/env python
+"""Checks that loaded optimized code matches what the JIT generates.
+
+Every test is run twice: once saving its optimized code and the inline cache
+states of its full code, then again loading that code with
+--saveload-validate, which also builds the chunk of every loaded function
+and reports where the loaded chunk differs.  The mjsunit tests and the
+Octane benchmarks in benchmarks/ are run by default:
+
+  tools/saveload-validate.py out/x64.release/d8
+  tools/saveload-validate.py --tests=mjsunit/array-sort out/x64.debug/d8
+
+A mismatch is reported with the name of the function, the instruction the
+chunks first differ at and what differs.  The replayed feedback covers
+arithmetic and comparisons only, so functions that were loaded before
+their property accesses ran may still differ because of missing feedback.
+The exit status is 1 if any test had a mismatch or failed to run.
+"""
+
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MJSUNIT_DIR = os.path.join(ROOT, 'test', 'mjsunit')
+BENCHMARKS_DIR = os.path.join(ROOT, 'benchmarks')
+BENCHMARKS = [
+  'richards', 'deltablue', 'crypto', 'raytrace', 'earley-boyer', 'regexp',
+  'splay', 'navier-stokes'
+]
+
+# Runs the suites defined by the loaded benchmark, without printing scores.
+DRIVER = """
+BenchmarkSuite.RunSuites({ NotifyError: function(name, error) {
+  print(name + ': ' + error);
+  quit(1);
+}});
+"""
+
+FLAGS_RE = re.compile(r'//\s+Flags:(.*)')
+MISMATCH_RE = re.compile(r'^\[optimized code for .* does not match .*\]$')
+
+
+def MjsunitTests(names):
+  """Returns (name, files, flags, cwd) for the mjsunit tests in |names|, or
+  all of them."""
+  tests = []
+  for directory, _, files in os.walk(MJSUNIT_DIR):
+    for filename in sorted(files):
+      if not filename.endswith('.js') or filename == 'mjsunit.js':
+        continue
+      path = os.path.join(directory, filename)
+      name = 'mjsunit/' + os.path.relpath(path, MJSUNIT_DIR)[:-3]
+      if names and name not in names:
+        continue
+      with open(path) as source:
+        flags = []
+        for match in FLAGS_RE.finditer(source.read()):
+          flags += match.group(1).split()
+      tests.append((name, [os.path.join(MJSUNIT_DIR, 'mjsunit.js'), path],
+                    flags, ROOT))
+  return sorted(tests)
+
+
+def BenchmarkTests(names, driver):
+  tests = []
+  for benchmark in BENCHMARKS:
+    name = 'octane/' + benchmark
+    if names and name not in names:
+      continue
+    tests.append((name, [os.path.join(BENCHMARKS_DIR, 'base.js'),
+                         os.path.join(BENCHMARKS_DIR, benchmark + '.js'),
+                         driver], [], BENCHMARKS_DIR))
+  return tests
+
+
+def RunD8(d8, flags, files, cwd):
+  """Returns the exit code and the output of d8."""
+  process = subprocess.Popen([d8] + flags + files, cwd=cwd,
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+  output = process.communicate()[0]
+  return process.returncode, output
+
+
+def Validate(d8, test, options, work_dir):
+  """Returns the mismatches of |test|, or None if it failed to run."""
+  name, files, test_flags, cwd = test
+  code_file = os.path.join(work_dir, 'code.lithium')
+  feedback_file = os.path.join(work_dir, 'code.feedback')
+  for path in [code_file, feedback_file]:
+    if os.path.exists(path):
+      os.remove(path)
+  flags = options.flags.split() + test_flags
+
+  code, output = RunD8(d8, flags + [
+    '--save-code', code_file, '--saveload-record-feedback', feedback_file
+  ], files, cwd)
+  if code != 0:
+    sys.stderr.write('%s: failed when saving code\n%s' % (name, output))
+    return None
+
+  code, output = RunD8(d8, flags + [
+    '--load-code', code_file, '--saveload-replay-feedback', feedback_file,
+    '--saveload-validate'
+  ], files, cwd)
+  mismatches = [line for line in output.splitlines()
+                if MISMATCH_RE.match(line.strip())]
+  if code != 0:
+    sys.stderr.write('%s: failed when loading code\n%s' % (name, output))
+    return None
+  return mismatches
+
+
+def Main():
+  parser = optparse.OptionParser(usage='%prog [options] d8')
+  parser.add_option('--flags', default='',
+                    help='extra d8 flags, e.g. --saveload-dev')
+  parser.add_option('--tests', default='',
+                    help='comma-separated tests to run, e.g. '
+                         'mjsunit/array-sort,octane/richards')
+  parser.add_option('--no-mjsunit', action='store_true',
+                    help='only run the benchmarks')
+  parser.add_option('--no-benchmarks', action='store_true',
+                    help='only run the mjsunit tests')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.print_help()
+    return 1
+  d8 = os.path.abspath(args[0])
+  names = set(filter(None, options.tests.split(',')))
+
+  work_dir = tempfile.mkdtemp(prefix='saveload-validate')
+  try:
+    driver = os.path.join(work_dir, 'driver.js')
+    with open(driver, 'w') as driver_file:
+      driver_file.write(DRIVER)
+    tests = []
+    if not options.no_mjsunit:
+      tests += MjsunitTests(names)
+    if not options.no_benchmarks:
+      tests += BenchmarkTests(names, driver)
+
+    failed = 0
+    mismatched = 0
+    for test in tests:
+      mismatches = Validate(d8, test, options, work_dir)
+      if mismatches is None:
+        failed += 1
+      elif mismatches:
+        mismatched += 1
+        print('%s:' % test[0])
+        for line in mismatches:
+          print('  ' + line)
+    print('%d tests, %d with mismatches, %d failed' %
+          (len(tests), mismatched, failed))
+  finally:
+    shutil.rmtree(work_dir)
+  return 1 if mismatched or failed else 0
+
+
+if __name__ == '__main__':
+  sys.exit(Main())